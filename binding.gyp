@@ -2,7 +2,8 @@
   "targets": [
     {
       "target_name": "memoryjs",
-      "sources": [ "lib/memoryjs.cc", "lib/process.cc", "lib/module.cc", "lib/pattern.cc" ]
+      "sources": [ "lib/memoryjs.cc", "lib/process.cc", "lib/module.cc", "lib/pattern.cc", "lib/gather.cc", "lib/instance.cc", "lib/pointerscan.cc", "lib/reader.cc", "lib/bufferpool.cc", "lib/scancontrol.cc", "lib/signature.cc", "lib/scheduler.cc", "lib/stringscan.cc", "lib/image.cc", "lib/recorder.cc" ],
+      "libraries": [ "winmm.lib" ]
     }
   ]
 }
@@ -1,5 +1,104 @@
 const memoryjs = require('./build/Release/memoryjs');
 
+// data types that have a typed accessor, these skip the data type string dispatch
+const typedReaders = {
+  int: memoryjs.readInt32,
+  dword: memoryjs.readUInt32,
+  long: memoryjs.readInt32,
+  float: memoryjs.readFloat,
+  double: memoryjs.readDouble,
+  ptr: memoryjs.readPtr,
+  pointer: memoryjs.readPtr,
+  bool: memoryjs.readBool,
+  boolean: memoryjs.readBool,
+};
+
+const typedWriters = {
+  int: memoryjs.writeInt32,
+  dword: memoryjs.writeUInt32,
+  long: memoryjs.writeInt32,
+  float: memoryjs.writeFloat,
+  double: memoryjs.writeDouble,
+  ptr: memoryjs.writePtr,
+  pointer: memoryjs.writePtr,
+  bool: memoryjs.writeBool,
+  boolean: memoryjs.writeBool,
+};
+
+// Wraps the columns returned by getProcessTable/getModuleTable/findStrings/getExports. The columns (TypedArrays) can be
+// used directly, row objects are only built when they are accessed and are then cached.
+class Table {
+  constructor(columns, fields, stringFields) {
+    this.columns = columns;
+    this.length = columns.length;
+    this.fields = fields;
+    this.stringFields = stringFields;
+    this.rows = new Array(columns.length);
+  }
+
+  // value of a single field without building the row
+  value(index, field) {
+    const value = this.columns[field][index];
+    return this.stringFields.indexOf(field) === -1 ? value : this.columns.strings[value];
+  }
+
+  get(index) {
+    if (this.rows[index] === undefined) {
+      const row = {};
+      this.fields.forEach((field) => {
+        row[field] = this.value(index, field);
+      });
+      this.rows[index] = row;
+    }
+
+    return this.rows[index];
+  }
+
+  toArray() {
+    const rows = new Array(this.length);
+    for (let i = 0; i < this.length; i += 1) {
+      rows[i] = this.get(i);
+    }
+    return rows;
+  }
+
+  [Symbol.iterator]() {
+    let index = 0;
+    return {
+      next: () => (index < this.length ? { value: this.get(index++), done: false } : { value: undefined, done: true }),
+    };
+  }
+}
+
+// A flag that stops a running scan. Scans run on the thread that started them, so a synchronous scan
+// can only be cancelled from another thread (pass the token's flag to a worker) or by a timeout.
+function createCancelToken() {
+  const flag = new Int32Array(new SharedArrayBuffer(4));
+  return {
+    flag,
+    cancel() {
+      Atomics.store(flag, 0, 1);
+    },
+    get cancelled() {
+      return Atomics.load(flag, 0) !== 0;
+    },
+  };
+}
+
+// Turns the cancellation options of a scan into what the native functions expect:
+// `token` (from createCancelToken) and `signal` (an AbortSignal) both become a cancelFlag.
+// Scans block the thread that runs them, so an abort event could never be delivered during one:
+// the signal is only checked when the scan starts and no listener is added.
+function scanOptions(options) {
+  const { token, signal, ...rest } = options;
+  if (!token && !signal) return options;
+
+  const cancelToken = token || createCancelToken();
+  if (signal && signal.aborted) cancelToken.cancel();
+
+  return { ...rest, cancelFlag: cancelToken.flag };
+}
+
 module.exports = {
 
   // data type constants
@@ -40,6 +139,14 @@ module.exports = {
     memoryjs.getProcesses(callback);
   },
 
+  getProcessTable() {
+    return new Table(
+      memoryjs.getProcessTable(),
+      ['cntThreads', 'szExeFile', 'th32ProcessID', 'th32ParentProcessID', 'pcPriClassBase'],
+      ['szExeFile'],
+    );
+  },
+
   findModule(moduleName, processId, callback) {
     if (arguments.length === 2) {
       return memoryjs.findModule(moduleName, processId);
@@ -56,33 +163,140 @@ module.exports = {
     memoryjs.getModules(processId, callback);
   },
 
+  getModuleTable(processId) {
+    return new Table(
+      memoryjs.getModuleTable(processId),
+      ['modBaseAddr', 'modBaseSize', 'szExePath', 'szModule', 'th32ModuleID'],
+      ['szExePath', 'szModule'],
+    );
+  },
+
   readMemory(handle, address, dataType, callback) {
-    if (arguments.length === 2) {
+    if (arguments.length === 3) {
+      const reader = typedReaders[dataType.toLowerCase()];
+      if (reader) {
+        return reader(handle, address);
+      }
+
       return memoryjs.readMemory(handle, address, dataType.toLowerCase());
     }
 
     memoryjs.readMemory(handle, address, dataType.toLowerCase(), callback);
   },
 
+  readArray(handle, address, dataType, count, output) {
+    return memoryjs.readArray(handle, address, dataType.toLowerCase(), count, output);
+  },
+
+  readStrided(handle, base, stride, count, fieldOffset, dataType, output) {
+    return memoryjs.readStrided(handle, base, stride, count, fieldOffset, dataType.toLowerCase(), output);
+  },
+
+  gatherFromPointers(handle, pointerArrayAddress, count, layout) {
+    const normalised = {};
+    Object.keys(layout).forEach((name) => {
+      normalised[name] = { offset: layout[name].offset, type: layout[name].type.toLowerCase() };
+    });
+
+    return memoryjs.gatherFromPointers(handle, pointerArrayAddress, count, normalised);
+  },
+
   writeMemory(handle, address, value, dataType, callback) {
     if (dataType === 'str' || dataType === 'string') {
       value = value + '\0'; // add terminator
     }
 
     if (arguments.length === 4) {
+      const writer = typedWriters[dataType.toLowerCase()];
+      if (writer) {
+        return writer(handle, address, value);
+      }
+
       return memoryjs.writeMemory(handle, address, value, dataType.toLowerCase());
     }
 
     memoryjs.writeMemory(handle, address, value, dataType.toLowerCase(), callback);
   },
 
-  findPattern(handle, moduleName, signature, signatureType, patternOffset, addressOffset, callback) {
-    if (arguments.length === 5) {
-      return memoryjs.findPattern(handle, moduleName, signature, signatureType, patternOffset, addressOffset);
+  findPattern(handle, moduleName, signature, signatureType, patternOffset, addressOffset, options, callback) {
+    if (typeof options === 'function') {
+      callback = options;
+      options = undefined;
+    }
+
+    const args = [handle, moduleName, signature, signatureType, patternOffset, addressOffset];
+    if (options) args.push(scanOptions(options));
+    if (callback) args.push(callback);
+
+    return memoryjs.findPattern(...args);
+  },
+
+  pointerScan(handle, target, options) {
+    return memoryjs.pointerScan(handle, target, scanOptions(options || {}));
+  },
+
+  rescanPointers: memoryjs.rescanPointers,
+
+  findStrings(handle, options) {
+    const opts = scanOptions(options || {});
+    const fields = opts.text === false ? ['address', 'characters', 'encoding'] : ['address', 'characters', 'encoding', 'text'];
+    const stringFields = fields.filter(field => field === 'encoding' || field === 'text');
+
+    if (opts.onStrings) {
+      const { onStrings } = opts;
+      return memoryjs.findStrings(handle, { ...opts, onStrings: batch => onStrings(new Table(batch, fields, stringFields)) });
     }
 
-    memoryjs.findPattern(handle, moduleName, signature, signatureType, patternOffset, addressOffset, callback);
+    const columns = memoryjs.findStrings(handle, opts);
+    const table = new Table(columns, fields, stringFields);
+    table.complete = columns.complete;
+    return table;
+  },
+
+  getExports(handle, moduleName) {
+    return new Table(
+      memoryjs.getExports(handle, moduleName),
+      ['name', 'ordinal', 'address', 'forwarder'],
+      ['name', 'forwarder'],
+    );
+  },
+
+  findExport: memoryjs.findExport,
+
+  record: memoryjs.record,
+  getRecordingStats: memoryjs.getRecordingStats,
+  stopRecording: memoryjs.stopRecording,
+
+  readRecording(path, options) {
+    const { from, to } = options || {};
+    // Date objects are accepted as well as timestamps
+    return memoryjs.readRecording(path, {
+      from: from instanceof Date ? from.getTime() : from,
+      to: to instanceof Date ? to.getTime() : to,
+    });
   },
 
+  createCancelToken,
+
+  setReaderOptions: memoryjs.setReaderOptions,
+  setBufferPoolOptions: memoryjs.setBufferPoolOptions,
+  getBufferPoolStats: memoryjs.getBufferPoolStats,
+  setSchedulerOptions: memoryjs.setSchedulerOptions,
+  getSchedulerStats: memoryjs.getSchedulerStats,
+
   closeProcess: memoryjs.closeProcess,
+
+  // typed accessors
+  readInt32: memoryjs.readInt32,
+  readUInt32: memoryjs.readUInt32,
+  readFloat: memoryjs.readFloat,
+  readDouble: memoryjs.readDouble,
+  readPtr: memoryjs.readPtr,
+  readBool: memoryjs.readBool,
+  writeInt32: memoryjs.writeInt32,
+  writeUInt32: memoryjs.writeUInt32,
+  writeFloat: memoryjs.writeFloat,
+  writeDouble: memoryjs.writeDouble,
+  writePtr: memoryjs.writePtr,
+  writeBool: memoryjs.writeBool,
 };
@@ -0,0 +1,183 @@
+#include <node.h>
+#include <windows.h>
+#include <vector>
+#include "bufferpool.h"
+
+bufferpool::bufferpool() : limit(DEFAULT_LIMIT), largePages(false), bytesReserved(0), hits(0), misses(0) {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  pageSize = info.dwPageSize;
+}
+
+bufferpool::~bufferpool() {
+  for (std::vector<Buffer>::size_type i = 0; i != buffers.size(); i++) freeBuffer(buffers[i]);
+}
+
+/* Returns a page-aligned buffer of at least `size` bytes, capacity receives its actual size.
+ * The smallest free buffer that fits is reused, otherwise a new one is committed. The pool never holds
+ * more than its limit: idle buffers are freed to make room, and if the buffers in use leave no room
+ * nullptr is returned. */
+unsigned char* bufferpool::acquire(SIZE_T size, SIZE_T* capacity) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  Buffer* best = nullptr;
+
+  for (std::vector<Buffer>::size_type i = 0; i != buffers.size(); i++) {
+    if (buffers[i].inUse || buffers[i].size < size) continue;
+    if (best == nullptr || buffers[i].size < best->size) best = &buffers[i];
+  }
+
+  if (best != nullptr) {
+    hits++;
+    best->inUse = true;
+    if (capacity != nullptr) *capacity = best->size;
+    return best->data;
+  }
+
+  misses++;
+
+  Buffer buffer = { nullptr, 0, true, false };
+  SIZE_T largePageSize = largePages ? GetLargePageMinimum() : 0;
+
+  // Large pages need SeLockMemoryPrivilege, fall back to normal pages if they can't be used
+  if (largePageSize != 0 && size >= largePageSize) {
+    buffer.size = (size + largePageSize - 1) / largePageSize * largePageSize;
+
+    if (makeRoom(buffer.size)) {
+      buffer.data = (unsigned char*)VirtualAlloc(NULL, buffer.size, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+      buffer.largePage = buffer.data != nullptr;
+    }
+  }
+
+  if (buffer.data == nullptr) {
+    buffer.size = (size + pageSize - 1) / pageSize * pageSize;
+    if (!makeRoom(buffer.size)) return nullptr;
+
+    buffer.data = (unsigned char*)VirtualAlloc(NULL, buffer.size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+  }
+
+  if (buffer.data == nullptr) return nullptr;
+
+  buffers.push_back(buffer);
+  bytesReserved += buffer.size;
+
+  if (capacity != nullptr) *capacity = buffer.size;
+  return buffer.data;
+}
+
+void bufferpool::release(unsigned char* data) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  for (std::vector<Buffer>::size_type i = 0; i != buffers.size(); i++) {
+    if (buffers[i].data == data) {
+      buffers[i].inUse = false;
+      break;
+    }
+  }
+
+  trim(limit);
+}
+
+/* Frees idle buffers until a new buffer of size bytes fits within the limit, returns false if it can't */
+bool bufferpool::makeRoom(SIZE_T size) {
+  if (size > limit) return false;
+
+  trim(limit - size);
+  return bytesReserved <= limit - size;
+}
+
+/* Frees unused buffers (largest first) until the pool holds at most target bytes */
+void bufferpool::trim(SIZE_T target) {
+  while (bytesReserved > target) {
+    std::vector<Buffer>::size_type largest = buffers.size();
+
+    for (std::vector<Buffer>::size_type i = 0; i != buffers.size(); i++) {
+      if (buffers[i].inUse) continue;
+      if (largest == buffers.size() || buffers[i].size > buffers[largest].size) largest = i;
+    }
+
+    if (largest == buffers.size()) return;
+
+    bytesReserved -= buffers[largest].size;
+    freeBuffer(buffers[largest]);
+    buffers.erase(buffers.begin() + largest);
+  }
+}
+
+void bufferpool::freeBuffer(const Buffer& buffer) {
+  VirtualFree(buffer.data, 0, MEM_RELEASE);
+}
+
+void bufferpool::setLimit(SIZE_T limit) {
+  std::lock_guard<std::mutex> guard(lock);
+  this->limit = limit;
+  trim(limit);
+}
+
+void bufferpool::setLargePages(bool enabled) {
+  std::lock_guard<std::mutex> guard(lock);
+  largePages = enabled;
+}
+
+bufferpool::Stats bufferpool::getStats() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  Stats stats = { bytesReserved, 0, limit, buffers.size(), 0, hits, misses };
+
+  for (std::vector<Buffer>::size_type i = 0; i != buffers.size(); i++) {
+    if (buffers[i].inUse) stats.bytesInUse += buffers[i].size;
+    if (buffers[i].largePage) stats.largePageBuffers++;
+  }
+
+  return stats;
+}
+
+bufferpool::Lease::Lease() : data(nullptr), size(0), pool(nullptr) {}
+
+bufferpool::Lease::Lease(bufferpool* pool, SIZE_T size) : data(nullptr), size(0), pool(nullptr) {
+  acquire(pool, size);
+}
+
+bufferpool::Lease::~Lease() {
+  release();
+}
+
+void bufferpool::Lease::acquire(bufferpool* pool, SIZE_T size) {
+  release();
+  this->pool = pool;
+  data = pool->acquire(size, &this->size);
+}
+
+void bufferpool::Lease::release() {
+  if (pool != nullptr && data != nullptr) pool->release(data);
+  data = nullptr;
+  size = 0;
+  pool = nullptr;
+}
+
+arena::arena() : current(0), used(0) {}
+arena::~arena() {}
+
+void* arena::allocate(SIZE_T size) {
+  // keep allocations 8 byte aligned
+  size = (size + 7) & ~(SIZE_T)7;
+
+  while (current < blocks.size() && used + size > blocks[current].size()) {
+    current++;
+    used = 0;
+  }
+
+  if (current == blocks.size()) {
+    blocks.push_back(std::vector<unsigned char>(size > BLOCK_SIZE ? size : BLOCK_SIZE));
+    used = 0;
+  }
+
+  void* data = &blocks[current][used];
+  used += size;
+  return data;
+}
+
+void arena::reset() {
+  current = 0;
+  used = 0;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <mutex>
+#include <vector>
+
+/* Pool of large page-aligned scratch buffers that are reused by scans and bulk reads
+ * instead of allocating (and zero-filling) a new buffer every time. The limit caps the
+ * memory the pool holds, buffers in use included: idle buffers are freed to make room for
+ * new ones, and acquire fails if the buffers in use leave no room. */
+class bufferpool {
+
+public:
+  bufferpool();
+  ~bufferpool();
+
+  struct Stats {
+    SIZE_T bytesReserved;
+    SIZE_T bytesInUse;
+    SIZE_T limit;
+    SIZE_T buffers;
+    SIZE_T largePageBuffers;
+    SIZE_T hits;
+    SIZE_T misses;
+  };
+
+  // Releases its buffer when it goes out of scope
+  class Lease {
+  public:
+    Lease();
+    Lease(bufferpool* pool, SIZE_T size);
+    ~Lease();
+
+    void acquire(bufferpool* pool, SIZE_T size);
+    void release();
+    unsigned char* data;
+    SIZE_T size;
+
+  private:
+    Lease(const Lease&);
+    Lease& operator=(const Lease&);
+    bufferpool* pool;
+  };
+
+  static const SIZE_T DEFAULT_LIMIT = 256 * 1024 * 1024;
+
+  unsigned char* acquire(SIZE_T size, SIZE_T* capacity);
+  void release(unsigned char* data);
+
+  void setLimit(SIZE_T limit);
+  void setLargePages(bool enabled);
+  Stats getStats();
+
+private:
+  struct Buffer {
+    unsigned char* data;
+    SIZE_T size;
+    bool inUse;
+    bool largePage;
+  };
+
+  bool makeRoom(SIZE_T size);
+  void trim(SIZE_T target);
+  static void freeBuffer(const Buffer& buffer);
+
+  std::mutex lock;
+  std::vector<Buffer> buffers;
+  SIZE_T limit;
+  SIZE_T pageSize;
+  bool largePages;
+  SIZE_T bytesReserved;
+  SIZE_T hits;
+  SIZE_T misses;
+};
+
+/* Bump allocator for small transient data (decoded strings etc.), everything is
+ * freed at once with reset() and the blocks are kept for the next call */
+class arena {
+
+public:
+  arena();
+  ~arena();
+
+  static const SIZE_T BLOCK_SIZE = 64 * 1024;
+
+  void* allocate(SIZE_T size);
+  void reset();
+
+private:
+  arena(const arena&);
+  arena& operator=(const arena&);
+
+  std::vector<std::vector<unsigned char>> blocks;
+  std::vector<std::vector<unsigned char>>::size_type current;
+  SIZE_T used;
+};
+#endif
+#pragma once
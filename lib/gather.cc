@@ -0,0 +1,108 @@
+#include <node.h>
+#include <windows.h>
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include "gather.h"
+#include "memoryjs.h"
+
+gather::gather() {}
+gather::~gather() {}
+
+/* Reads a table of `count` pointers and then `fields` from every object it points to.
+ * Null/invalid pointers are skipped, the remaining objects are sorted by address and objects
+ * that are close together (same or neighbouring pages) are fetched with a single read.
+ * 
+ * pointers receives the pointer table, outputs[i] receives count * fields[i].size bytes
+ * and valid[i] is set to 1 if object i could be read. */
+bool gather::gatherFromPointers(HANDLE handle, DWORD64 pointerArray, SIZE_T count, const std::vector<Field>& fields,
+  std::vector<uintptr_t>& pointers, std::vector<unsigned char*>& outputs, unsigned char* valid, bufferpool& pool, char** errorMessage) {
+
+  pointers.resize(count);
+  memset(valid, 0, count);
+
+  if (count == 0) return true;
+
+  if (!ReadProcessMemory(handle, LPCVOID(pointerArray), &pointers[0], count * sizeof(uintptr_t), nullptr)) {
+    *errorMessage = "unable to read pointer table";
+    return false;
+  }
+
+  if (fields.empty()) return true;
+
+  // The part of each object that has to be read
+  SIZE_T spanStart = (SIZE_T)-1;
+  SIZE_T spanEnd = 0;
+
+  for (std::vector<Field>::size_type i = 0; i != fields.size(); i++) {
+    spanStart = (std::min)(spanStart, fields[i].offset);
+    spanEnd = (std::max)(spanEnd, fields[i].offset + fields[i].size);
+  }
+
+  // Objects that can be read, sorted by address
+  std::vector<SIZE_T> order;
+  order.reserve(count);
+
+  for (SIZE_T i = 0; i < count; i++) {
+    uintptr_t pointer = pointers[i];
+    if (pointer < MIN_POINTER || pointer + spanEnd < pointer) continue;
+    order.push_back(i);
+  }
+
+  std::sort(order.begin(), order.end(), [&](SIZE_T a, SIZE_T b) {
+    return pointers[a] < pointers[b];
+  });
+
+  // merged reads are at most MAX_READ_SIZE plus the span of the object that extends past it
+  bufferpool::Lease buffer(&pool, MAX_READ_SIZE + (spanEnd - spanStart));
+
+  if (buffer.data == nullptr) {
+    *errorMessage = "unable to allocate a read buffer";
+    return false;
+  }
+
+  for (std::vector<SIZE_T>::size_type first = 0; first < order.size();) {
+    uintptr_t groupStart = pointers[order[first]] + spanStart;
+    uintptr_t groupEnd = pointers[order[first]] + spanEnd;
+
+    // Extend the group while the next object is close enough
+    std::vector<SIZE_T>::size_type last = first + 1;
+    for (; last < order.size(); last++) {
+      uintptr_t start = pointers[order[last]] + spanStart;
+      uintptr_t end = pointers[order[last]] + spanEnd;
+
+      if (start > groupEnd + MERGE_GAP || end - groupStart > MAX_READ_SIZE) break;
+      groupEnd = (std::max)(groupEnd, end);
+    }
+
+    SIZE_T groupSize = groupEnd - groupStart;
+
+    if (ReadProcessMemory(handle, LPCVOID(groupStart), buffer.data, groupSize, nullptr)) {
+      for (std::vector<SIZE_T>::size_type i = first; i < last; i++) {
+        decode(buffer.data, groupStart, pointers[order[i]], order[i], fields, outputs);
+        valid[order[i]] = 1;
+      }
+    } else {
+      // Part of the group is not readable, fall back to reading the objects one by one
+      for (std::vector<SIZE_T>::size_type i = first; i < last; i++) {
+        uintptr_t object = pointers[order[i]];
+        if (!ReadProcessMemory(handle, LPCVOID(object + spanStart), buffer.data, spanEnd - spanStart, nullptr)) continue;
+        decode(buffer.data, object + spanStart, object, order[i], fields, outputs);
+        valid[order[i]] = 1;
+      }
+    }
+
+    first = last;
+  }
+
+  return true;
+}
+
+/* Copies the fields of one object out of a buffer that was read from bufferBase */
+void gather::decode(const unsigned char* buffer, uintptr_t bufferBase, uintptr_t object, SIZE_T index,
+  const std::vector<Field>& fields, std::vector<unsigned char*>& outputs) {
+  for (std::vector<Field>::size_type f = 0; f != fields.size(); f++) {
+    SIZE_T size = fields[f].size;
+    memcpy(outputs[f] + index * size, buffer + (object + fields[f].offset - bufferBase), size);
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#ifndef GATHER_H
+#define GATHER_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <vector>
+#include "bufferpool.h"
+
+class gather {
+
+public:
+  gather();
+  ~gather();
+
+  // A field to read from every object, relative to the object's pointer
+  struct Field {
+    SIZE_T offset;
+    SIZE_T size;
+  };
+
+  // Objects that are at most this many bytes apart are fetched with the same read
+  static const SIZE_T MERGE_GAP = 0x1000;
+
+  // Upper limit on the size of a single merged read
+  static const SIZE_T MAX_READ_SIZE = 1024 * 1024;
+
+  // Addresses below this are never valid user mode pointers
+  static const uintptr_t MIN_POINTER = 0x10000;
+
+  bool gatherFromPointers(HANDLE handle, DWORD64 pointerArray, SIZE_T count, const std::vector<Field>& fields,
+    std::vector<uintptr_t>& pointers, std::vector<unsigned char*>& outputs, unsigned char* valid, bufferpool& pool, char** errorMessage);
+
+private:
+  void decode(const unsigned char* buffer, uintptr_t bufferBase, uintptr_t object, SIZE_T index,
+    const std::vector<Field>& fields, std::vector<unsigned char*>& outputs);
+};
+#endif
+#pragma once
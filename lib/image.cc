@@ -0,0 +1,376 @@
+#include <node.h>
+#include <windows.h>
+#include <TlHelp32.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "image.h"
+#include "memory.h"
+
+// Limits used while following forwarded exports and reading names that lie outside the export directory
+static const int MAX_FORWARD_DEPTH = 8;
+static const DWORD MAX_NAME_LENGTH = 512;
+
+image::image() {}
+image::~image() {}
+
+static std::string toLower(const char* value) {
+  std::string result(value);
+  std::transform(result.begin(), result.end(), result.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+  return result;
+}
+
+/* Looks the module up by name the first time, afterwards the cached module is used as long as it is still loaded */
+image::Info* image::getInfo(HANDLE handle, const char* moduleName, module& Module, char** errorMessage) {
+  DWORD processId = GetProcessId(handle);
+  std::pair<DWORD, std::string> key(processId, toLower(moduleName));
+
+  std::map<std::pair<DWORD, std::string>, Info>::iterator cached = modules.find(key);
+
+  if (cached != modules.end()) {
+    if (isCurrent(handle, cached->second)) return &cached->second;
+    modules.erase(cached);
+  }
+
+  std::vector<MODULEENTRY32> moduleEntries = Module.getModules(processId, errorMessage);
+  if (strcmp(*errorMessage, "")) return nullptr;
+
+  for (std::vector<MODULEENTRY32>::size_type i = 0; i != moduleEntries.size(); i++) {
+    if (toLower(moduleEntries[i].szModule) != key.second) continue;
+
+    Info info;
+    info.name = moduleEntries[i].szModule;
+    info.base = (uintptr_t)moduleEntries[i].modBaseAddr;
+    info.size = moduleEntries[i].modBaseSize;
+    info.exportsParsed = false;
+
+    if (!parseHeaders(handle, info, errorMessage)) return nullptr;
+
+    return &(modules[key] = info);
+  }
+
+  *errorMessage = "unable to find module";
+  return nullptr;
+}
+
+/* Reads the first page of the module and finds its NT headers */
+bool image::parseHeaders(HANDLE handle, Info& info, char** errorMessage) {
+  unsigned char headers[0x1000];
+  SIZE_T headerSize = (std::min)((SIZE_T)sizeof(headers), info.size);
+
+  if (headerSize < sizeof(IMAGE_DOS_HEADER) || !memory::readBuffer(handle, info.base, headers, headerSize)) {
+    *errorMessage = "unable to read the module headers";
+    return false;
+  }
+
+  const IMAGE_DOS_HEADER* dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(headers);
+
+  if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE || dosHeader->e_lfanew <= 0
+    || (SIZE_T)dosHeader->e_lfanew + sizeof(IMAGE_NT_HEADERS64) > headerSize) {
+    *errorMessage = "module does not have valid PE headers";
+    return false;
+  }
+
+  // the 32 and 64 bit headers only differ after the file header
+  const IMAGE_NT_HEADERS32* ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS32*>(headers + dosHeader->e_lfanew);
+
+  if (ntHeaders->Signature != IMAGE_NT_SIGNATURE) {
+    *errorMessage = "module does not have valid PE headers";
+    return false;
+  }
+
+  info.headerOffset = (DWORD)dosHeader->e_lfanew;
+  info.timeDateStamp = ntHeaders->FileHeader.TimeDateStamp;
+
+  if (ntHeaders->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
+    info.exportDirectory = reinterpret_cast<const IMAGE_NT_HEADERS64*>(ntHeaders)->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+  } else {
+    info.exportDirectory = ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+  }
+
+  // the section table follows the optional header, it is read separately if it doesn't fit in the first page
+  SIZE_T sectionOffset = (SIZE_T)dosHeader->e_lfanew + FIELD_OFFSET(IMAGE_NT_HEADERS32, OptionalHeader) + ntHeaders->FileHeader.SizeOfOptionalHeader;
+  SIZE_T sectionCount = ntHeaders->FileHeader.NumberOfSections;
+  std::vector<IMAGE_SECTION_HEADER> sectionHeaders(sectionCount);
+
+  if (sectionCount > 0) {
+    SIZE_T tableSize = sectionCount * sizeof(IMAGE_SECTION_HEADER);
+
+    if (sectionOffset + tableSize <= headerSize) {
+      memcpy(&sectionHeaders[0], headers + sectionOffset, tableSize);
+    } else if (sectionOffset + tableSize > info.size || !memory::readBuffer(handle, info.base + sectionOffset, &sectionHeaders[0], tableSize)) {
+      *errorMessage = "unable to read the module's section headers";
+      return false;
+    }
+  }
+
+  info.sections.clear();
+
+  for (std::vector<IMAGE_SECTION_HEADER>::size_type i = 0; i != sectionHeaders.size(); i++) {
+    const IMAGE_SECTION_HEADER& header = sectionHeaders[i];
+    const char* name = reinterpret_cast<const char*>(header.Name);
+
+    // names are padded with zeros, but use all 8 bytes if they are that long
+    Section section;
+    section.name = std::string(name, std::find(name, name + IMAGE_SIZEOF_SHORT_NAME, '\0'));
+    section.virtualAddress = header.VirtualAddress;
+    section.size = header.Misc.VirtualSize != 0 ? header.Misc.VirtualSize : header.SizeOfRawData;
+    section.characteristics = header.Characteristics;
+    info.sections.push_back(section);
+  }
+
+  return true;
+}
+
+/* A cached module is still current if the same headers are at its base */
+bool image::isCurrent(HANDLE handle, const Info& info) {
+  struct {
+    DWORD signature;
+    IMAGE_FILE_HEADER fileHeader;
+  } headers;
+
+  return memory::readBuffer(handle, info.base + info.headerOffset, &headers, sizeof(headers))
+    && headers.signature == IMAGE_NT_SIGNATURE && headers.fileHeader.TimeDateStamp == info.timeDateStamp;
+}
+
+/* Reads the export directory in one block. The arrays and names it points to are normally inside it,
+ * anything that isn't is covered by reading one larger block instead. */
+bool image::parseExports(HANDLE handle, Info& info, char** errorMessage) {
+  DWORD directoryRva = info.exportDirectory.VirtualAddress;
+  DWORD directorySize = info.exportDirectory.Size;
+
+  info.exports.clear();
+  info.exportNames.clear();
+  info.exportOrdinals.clear();
+
+  if (directoryRva == 0 || directorySize < sizeof(IMAGE_EXPORT_DIRECTORY)) {
+    info.exportsParsed = true;
+    return true;
+  }
+
+  std::vector<unsigned char> block;
+  DWORD blockRva = 0;
+  DWORD low = directoryRva;
+  DWORD high = directoryRva + directorySize;
+
+  auto readBlock = [&]() {
+    if (low >= high || high > info.size) return false;
+
+    block.resize(high - low);
+    blockRva = low;
+    return memory::readBuffer(handle, info.base + low, &block[0], block.size());
+  };
+
+  auto contains = [&](DWORD rva, DWORD size) {
+    return rva >= blockRva && (ULONGLONG)rva + size <= (ULONGLONG)blockRva + block.size();
+  };
+
+  auto include = [&](DWORD rva, DWORD size) {
+    low = (std::min)(low, rva);
+    high = (DWORD)(std::min)((ULONGLONG)info.size, (std::max)((ULONGLONG)high, (ULONGLONG)rva + size));
+  };
+
+  if (!readBlock()) {
+    *errorMessage = "unable to read the export directory";
+    return false;
+  }
+
+  IMAGE_EXPORT_DIRECTORY directory = *reinterpret_cast<const IMAGE_EXPORT_DIRECTORY*>(&block[0]);
+  DWORD functionsSize = directory.NumberOfFunctions * sizeof(DWORD);
+  DWORD namesSize = directory.NumberOfNames * sizeof(DWORD);
+  DWORD ordinalsSize = directory.NumberOfNames * sizeof(WORD);
+
+  if (directory.NumberOfFunctions > info.size / sizeof(DWORD) || directory.NumberOfNames > info.size / sizeof(DWORD)) {
+    *errorMessage = "invalid export directory";
+    return false;
+  }
+
+  if (!contains(directory.AddressOfFunctions, functionsSize) || !contains(directory.AddressOfNames, namesSize)
+    || !contains(directory.AddressOfNameOrdinals, ordinalsSize)) {
+    include(directory.AddressOfFunctions, functionsSize);
+    include(directory.AddressOfNames, namesSize);
+    include(directory.AddressOfNameOrdinals, ordinalsSize);
+
+    if (!readBlock() || !contains(directory.AddressOfFunctions, functionsSize) || !contains(directory.AddressOfNames, namesSize)
+      || !contains(directory.AddressOfNameOrdinals, ordinalsSize)) {
+      *errorMessage = "unable to read the export directory";
+      return false;
+    }
+  }
+
+  const DWORD* functionData = reinterpret_cast<const DWORD*>(&block[directory.AddressOfFunctions - blockRva]);
+  const DWORD* nameData = reinterpret_cast<const DWORD*>(&block[directory.AddressOfNames - blockRva]);
+  const WORD* ordinalData = reinterpret_cast<const WORD*>(&block[directory.AddressOfNameOrdinals - blockRva]);
+
+  std::vector<DWORD> functions(functionData, functionData + directory.NumberOfFunctions);
+  std::vector<DWORD> names(nameData, nameData + directory.NumberOfNames);
+  std::vector<WORD> ordinals(ordinalData, ordinalData + directory.NumberOfNames);
+
+  bool namesOutside = false;
+
+  for (std::vector<DWORD>::size_type i = 0; i != names.size(); i++) {
+    if (contains(names[i], 1)) continue;
+
+    include(names[i], MAX_NAME_LENGTH);
+    namesOutside = true;
+  }
+
+  if (namesOutside && !readBlock()) {
+    *errorMessage = "unable to read the export names";
+    return false;
+  }
+
+  auto readString = [&](DWORD rva) {
+    if (!contains(rva, 1)) return std::string();
+
+    const char* value = reinterpret_cast<const char*>(&block[rva - blockRva]);
+    SIZE_T maxLength = blockRva + block.size() - rva;
+    return std::string(value, std::find(value, value + maxLength, '\0'));
+  };
+
+  auto addExport = [&](const std::string& name, DWORD index) {
+    Export entry;
+    entry.name = name;
+    entry.ordinal = directory.Base + index;
+    entry.address = info.base + functions[index];
+
+    // exports that point into the export directory are forwarder strings
+    if (functions[index] >= directoryRva && functions[index] < directoryRva + directorySize) {
+      entry.forwarder = readString(functions[index]);
+      entry.address = 0;
+    }
+
+    if (!name.empty()) info.exportNames.insert(std::make_pair(name, info.exports.size()));
+    info.exportOrdinals.insert(std::make_pair(entry.ordinal, info.exports.size()));
+    info.exports.push_back(entry);
+  };
+
+  std::vector<bool> named(functions.size(), false);
+
+  for (std::vector<DWORD>::size_type i = 0; i != names.size(); i++) {
+    if (ordinals[i] >= functions.size()) continue;
+
+    named[ordinals[i]] = true;
+    addExport(readString(names[i]), ordinals[i]);
+  }
+
+  // exports without a name can only be found by ordinal
+  for (std::vector<DWORD>::size_type i = 0; i != functions.size(); i++) {
+    if (!named[i] && functions[i] != 0) addExport("", (DWORD)i);
+  }
+
+  info.exportsParsed = true;
+  return true;
+}
+
+image::Info* image::getExports(HANDLE handle, const char* moduleName, module& Module, char** errorMessage) {
+  Info* info = getInfo(handle, moduleName, Module, errorMessage);
+  if (info == nullptr) return nullptr;
+
+  if (!info->exportsParsed && !parseExports(handle, *info, errorMessage)) return nullptr;
+
+  return info;
+}
+
+/* Returns the address of an export, following forwarders to the module they point to (if it is loaded) */
+uintptr_t image::findExport(HANDLE handle, const char* moduleName, const char* name, DWORD ordinal, module& Module, char** errorMessage) {
+  std::string currentModule = moduleName;
+  std::string currentName = name != nullptr ? name : "";
+  bool byName = name != nullptr;
+
+  for (int depth = 0; depth < MAX_FORWARD_DEPTH; depth++) {
+    Info* info = getExports(handle, currentModule.c_str(), Module, errorMessage);
+    if (info == nullptr) return 0;
+
+    std::unordered_map<std::string, size_t>::const_iterator foundName;
+    std::unordered_map<DWORD, size_t>::const_iterator foundOrdinal;
+    const Export* entry = nullptr;
+
+    if (byName && (foundName = info->exportNames.find(currentName)) != info->exportNames.end()) {
+      entry = &info->exports[foundName->second];
+    } else if (!byName && (foundOrdinal = info->exportOrdinals.find(ordinal)) != info->exportOrdinals.end()) {
+      entry = &info->exports[foundOrdinal->second];
+    }
+
+    if (entry == nullptr) {
+      *errorMessage = "unable to find export";
+      return 0;
+    }
+
+    if (entry->forwarder.empty()) return entry->address;
+
+    // "module.function" or "module.#ordinal", the module name has no extension
+    std::string::size_type dot = entry->forwarder.rfind('.');
+
+    if (dot == std::string::npos) {
+      *errorMessage = "invalid forwarded export";
+      return 0;
+    }
+
+    currentModule = entry->forwarder.substr(0, dot) + ".dll";
+    currentName = entry->forwarder.substr(dot + 1);
+    byName = currentName.empty() || currentName[0] != '#';
+    if (!byName) ordinal = (DWORD)strtoul(currentName.c_str() + 1, nullptr, 10);
+  }
+
+  *errorMessage = "too many forwarded exports";
+  return 0;
+}
+
+void image::clear() {
+  modules.clear();
+}
+
+std::vector<reader::Range> image::getSectionRanges(const Info& info, const std::vector<std::string>& names) {
+  std::vector<reader::Range> ranges;
+
+  for (std::vector<Section>::size_type i = 0; i != info.sections.size(); i++) {
+    const Section& section = info.sections[i];
+    bool selected = names.empty()
+      ? (section.characteristics & (IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_CNT_CODE)) != 0
+      : std::find(names.begin(), names.end(), section.name) != names.end();
+
+    if (!selected || section.virtualAddress >= info.size) continue;
+
+    reader::Range range = { info.base + section.virtualAddress, (std::min)((SIZE_T)section.size, info.size - section.virtualAddress) };
+    if (range.size > 0) ranges.push_back(range);
+  }
+
+  std::sort(ranges.begin(), ranges.end(), [](const reader::Range& a, const reader::Range& b) { return a.address < b.address; });
+
+  // sections are usually contiguous, merging them lets matches span them
+  std::vector<reader::Range> merged;
+
+  for (std::vector<reader::Range>::size_type i = 0; i != ranges.size(); i++) {
+    if (!merged.empty() && ranges[i].address <= merged.back().address + merged.back().size) {
+      uintptr_t end = (std::max)(merged.back().address + merged.back().size, ranges[i].address + ranges[i].size);
+      merged.back().size = end - merged.back().address;
+    } else {
+      merged.push_back(ranges[i]);
+    }
+  }
+
+  return merged;
+}
+
+std::vector<reader::Range> image::getRemainingRanges(const Info& info, const std::vector<reader::Range>& ranges) {
+  std::vector<reader::Range> remaining;
+  uintptr_t position = info.base;
+  uintptr_t end = info.base + info.size;
+
+  for (std::vector<reader::Range>::size_type i = 0; i <= ranges.size(); i++) {
+    uintptr_t next = i == ranges.size() ? end : ranges[i].address;
+
+    if (next > position) {
+      reader::Range range = { position, next - position };
+      remaining.push_back(range);
+    }
+
+    if (i != ranges.size()) position = (std::max)(position, ranges[i].address + ranges[i].size);
+  }
+
+  return remaining;
+}
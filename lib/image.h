@@ -0,0 +1,77 @@
+#pragma once
+#ifndef IMAGE_H
+#define IMAGE_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <TlHelp32.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "module.h"
+#include "reader.h"
+
+/* Parsed PE headers (sections and exports) of the modules of a process. Modules are looked up once by name and then cached
+ * by process id and name, a cached module is checked against the time stamp in its headers (one small read)
+ * before it is used, so a module that was unloaded and replaced is parsed again. */
+class image {
+
+public:
+  image();
+  ~image();
+
+  struct Export {
+    std::string name;
+    DWORD ordinal;
+    uintptr_t address;
+    // "module.function" or "module.#ordinal" if the export is forwarded to another module
+    std::string forwarder;
+  };
+
+  struct Section {
+    std::string name;
+    DWORD virtualAddress;
+    DWORD size;
+    DWORD characteristics;
+  };
+
+  struct Info {
+    std::string name;
+    uintptr_t base;
+    SIZE_T size;
+    DWORD headerOffset;
+    DWORD timeDateStamp;
+    IMAGE_DATA_DIRECTORY exportDirectory;
+    std::vector<Section> sections;
+
+    bool exportsParsed;
+    std::vector<Export> exports;
+    std::unordered_map<std::string, size_t> exportNames;
+    std::unordered_map<DWORD, size_t> exportOrdinals;
+  };
+
+  Info* getInfo(HANDLE handle, const char* moduleName, module& Module, char** errorMessage);
+  Info* getExports(HANDLE handle, const char* moduleName, module& Module, char** errorMessage);
+  // looks an export up by name, or by ordinal if name is null, and follows forwarders
+  uintptr_t findExport(HANDLE handle, const char* moduleName, const char* name, DWORD ordinal, module& Module, char** errorMessage);
+  void clear();
+
+  // ranges of the sections with the given names, or of the executable sections if names is empty,
+  // in address order with adjacent sections merged
+  static std::vector<reader::Range> getSectionRanges(const Info& info, const std::vector<std::string>& names);
+  // the parts of the module that are not covered by ranges (which must be in address order)
+  static std::vector<reader::Range> getRemainingRanges(const Info& info, const std::vector<reader::Range>& ranges);
+
+private:
+  bool parseHeaders(HANDLE handle, Info& info, char** errorMessage);
+  bool parseExports(HANDLE handle, Info& info, char** errorMessage);
+  bool isCurrent(HANDLE handle, const Info& info);
+
+  // keyed by process id and lower case module name
+  std::map<std::pair<DWORD, std::string>, Info> modules;
+};
+#endif
+#pragma once
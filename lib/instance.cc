@@ -0,0 +1,68 @@
+#include <node.h>
+#include <windows.h>
+#include "instance.h"
+
+static const char* keyNames[instance::KEY_COUNT] = {
+  "cntThreads",
+  "szExeFile",
+  "th32ProcessID",
+  "th32ParentProcessID",
+  "pcPriClassBase",
+  "modBaseAddr",
+  "modBaseSize",
+  "szExePath",
+  "szModule",
+  "th32ModuleID",
+  "length",
+  "strings"
+};
+
+instance::instance(Isolate* isolate) : Reader(Pool), isolate(isolate) {
+  for (int i = 0; i < KEY_COUNT; i++) {
+    v8::Local<v8::String> name = v8::String::NewFromUtf8(isolate, keyNames[i], v8::NewStringType::kInternalized).ToLocalChecked();
+    keys[i].Set(isolate, name);
+  }
+
+  // objects created from these templates all start out with the same shape
+  v8::Local<v8::ObjectTemplate> process = v8::ObjectTemplate::New(isolate);
+  process->Set(key(KEY_CNT_THREADS), v8::Undefined(isolate));
+  process->Set(key(KEY_SZ_EXE_FILE), v8::Undefined(isolate));
+  process->Set(key(KEY_TH32_PROCESS_ID), v8::Undefined(isolate));
+  process->Set(key(KEY_TH32_PARENT_PROCESS_ID), v8::Undefined(isolate));
+  process->Set(key(KEY_PC_PRI_CLASS_BASE), v8::Undefined(isolate));
+  processTemplate.Set(isolate, process);
+
+  v8::Local<v8::ObjectTemplate> module = v8::ObjectTemplate::New(isolate);
+  module->Set(key(KEY_MOD_BASE_ADDR), v8::Undefined(isolate));
+  module->Set(key(KEY_MOD_BASE_SIZE), v8::Undefined(isolate));
+  module->Set(key(KEY_SZ_EXE_PATH), v8::Undefined(isolate));
+  module->Set(key(KEY_SZ_MODULE), v8::Undefined(isolate));
+  module->Set(key(KEY_TH32_MODULE_ID), v8::Undefined(isolate));
+  moduleTemplate.Set(isolate, module);
+
+  // free this instance when the environment (main thread or worker) that loaded it is torn down
+  node::AddEnvironmentCleanupHook(isolate, cleanup, this);
+}
+
+instance::~instance() {}
+
+v8::Local<v8::String> instance::key(Key name) {
+  return keys[name].Get(isolate);
+}
+
+v8::Local<v8::Object> instance::newProcessObject() {
+  return processTemplate.Get(isolate)->NewInstance(isolate->GetCurrentContext()).ToLocalChecked();
+}
+
+v8::Local<v8::Object> instance::newModuleObject() {
+  return moduleTemplate.Get(isolate)->NewInstance(isolate->GetCurrentContext()).ToLocalChecked();
+}
+
+/* Every method is created with its instance as the function's data */
+instance* instance::get(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  return static_cast<instance*>(v8::Local<v8::External>::Cast(args.Data())->Value());
+}
+
+void instance::cleanup(void* arg) {
+  delete static_cast<instance*>(arg);
+}
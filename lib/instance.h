@@ -0,0 +1,80 @@
+#pragma once
+#ifndef INSTANCE_H
+#define INSTANCE_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include "process.h"
+#include "module.h"
+#include "memory.h"
+#include "pattern.h"
+#include "gather.h"
+#include "pointerscan.h"
+#include "reader.h"
+#include "stringscan.h"
+#include "image.h"
+#include "recorder.h"
+#include "bufferpool.h"
+
+using v8::Isolate;
+
+/* State owned by one instance of the addon. The addon is context-aware, so the main thread and
+ * every worker thread that loads it get their own instance, which is destroyed with the environment.
+ * Process handles are not part of an instance: they are plain numbers that are valid in every thread
+ * of the Node process and can be posted between workers. */
+class instance {
+
+public:
+  instance(Isolate* isolate);
+  ~instance();
+
+  // declared first, the reader and scans draw their buffers from it
+  bufferpool Pool;
+  arena Scratch;
+
+  process Process;
+  module Module;
+  memory Memory;
+  pattern Pattern;
+  gather Gather;
+  pointerscan PointerScan;
+  stringscan StringScan;
+  image Image;
+  recorder Recorder;
+  reader Reader;
+
+  Isolate* isolate;
+
+  // Property names used when building process/module objects, created once per instance
+  enum Key {
+    KEY_CNT_THREADS,
+    KEY_SZ_EXE_FILE,
+    KEY_TH32_PROCESS_ID,
+    KEY_TH32_PARENT_PROCESS_ID,
+    KEY_PC_PRI_CLASS_BASE,
+    KEY_MOD_BASE_ADDR,
+    KEY_MOD_BASE_SIZE,
+    KEY_SZ_EXE_PATH,
+    KEY_SZ_MODULE,
+    KEY_TH32_MODULE_ID,
+    KEY_LENGTH,
+    KEY_STRINGS,
+    KEY_COUNT
+  };
+
+  v8::Local<v8::String> key(Key name);
+  v8::Local<v8::Object> newProcessObject();
+  v8::Local<v8::Object> newModuleObject();
+
+private:
+  v8::Eternal<v8::String> keys[KEY_COUNT];
+  v8::Eternal<v8::ObjectTemplate> processTemplate;
+  v8::Eternal<v8::ObjectTemplate> moduleTemplate;
+
+public:
+  static instance* get(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void cleanup(void* arg);
+};
+#endif
+#pragma once
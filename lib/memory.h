@@ -6,14 +6,54 @@
 #include <node.h>
 #include <windows.h>
 #include <TlHelp32.h>
+#include <string.h>
+#include <vector>
+#include "bufferpool.h"
 
 using v8::Isolate;
 
+// memory has no state, the read/write helpers are static so they can be used
+// without the addon instance
 class memory {
 
 public:
+  // Maximum number of bytes read at once when gathering strided fields
+  static const SIZE_T STRIDED_WINDOW_SIZE = 1024 * 1024;
+
+  struct Region {
+    uintptr_t base;
+    SIZE_T size;
+    DWORD protect;
+    DWORD type;
+  };
+
+  // Lists the committed, readable regions of a process (or only the writable ones)
+  static std::vector<Region> getRegions(HANDLE hProcess, bool writableOnly) {
+    const DWORD readable = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+    const DWORD writable = PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+
+    std::vector<Region> regions;
+    MEMORY_BASIC_INFORMATION info;
+    uintptr_t address = 0;
+
+    while (VirtualQueryEx(hProcess, (LPCVOID)address, &info, sizeof(info)) == sizeof(info)) {
+      uintptr_t next = (uintptr_t)info.BaseAddress + info.RegionSize;
+
+      if (info.State == MEM_COMMIT && !(info.Protect & PAGE_GUARD) && (info.Protect & (writableOnly ? writable : readable))) {
+        Region region = { (uintptr_t)info.BaseAddress, info.RegionSize, info.Protect, info.Type };
+        regions.push_back(region);
+      }
+
+      // stop at the end of the address space
+      if (next <= address) break;
+      address = next;
+    }
+
+    return regions;
+  }
+
   template <class dataType>
-  dataType readMemory(HANDLE hProcess, DWORD64 dwAddress) {
+  static dataType readMemory(HANDLE hProcess, DWORD64 dwAddress) {
     dataType cRead;
     ReadProcessMemory(hProcess, (LPVOID)dwAddress, &cRead, sizeof(dataType), NULL);
     return cRead;
@@ -25,6 +65,106 @@ public:
     return value;
   }
 
+  // Reads a block of memory into a caller owned buffer, returns false if the whole block couldn't be read
+  static bool readBuffer(HANDLE hProcess, DWORD64 dwAddress, void* buffer, SIZE_T size) {
+    SIZE_T bytesRead = 0;
+    return ReadProcessMemory(hProcess, (LPVOID)dwAddress, buffer, size, &bytesRead) && bytesRead == size;
+  }
+
+  // Reads the field at fieldOffset from count structs that are stride bytes apart, into a packed output buffer.
+  // The range covering the structs is read in large windows and the field is gathered locally.
+  // The window comes from the pool, so reading the same structs every frame doesn't allocate.
+  static bool readStrided(HANDLE hProcess, DWORD64 dwBase, SIZE_T stride, SIZE_T count, SIZE_T fieldOffset, SIZE_T elementSize,
+    unsigned char* output, bufferpool& pool) {
+    if (count == 0) return true;
+
+    // packed fields are just one contiguous read
+    if (stride == elementSize) {
+      return readBuffer(hProcess, dwBase + fieldOffset, output, count * elementSize);
+    }
+
+    SIZE_T perWindow = STRIDED_WINDOW_SIZE / stride;
+    bufferpool::Lease window;
+
+    // the window only has to reach the end of the last field, not the end of the last struct
+    if (perWindow > 0) window.acquire(&pool, ((count < perWindow ? count : perWindow) - 1) * stride + elementSize);
+
+    // structs are too far apart for the covering range to be worth reading (or the pool is full), read each field on its own
+    if (window.data == nullptr) {
+      for (SIZE_T i = 0; i < count; i++) {
+        if (!readBuffer(hProcess, dwBase + i * stride + fieldOffset, output + i * elementSize, elementSize)) return false;
+      }
+
+      return true;
+    }
+
+    for (SIZE_T first = 0; first < count; first += perWindow) {
+      SIZE_T structs = count - first < perWindow ? count - first : perWindow;
+      SIZE_T windowSize = (structs - 1) * stride + elementSize;
+      if (!readBuffer(hProcess, dwBase + first * stride + fieldOffset, window.data, windowSize)) return false;
+
+      gather(window.data, stride, structs, elementSize, output + first * elementSize);
+    }
+
+    return true;
+  }
+
+  // Copies count fields of elementSize bytes that are stride bytes apart into a packed buffer.
+  // Common sizes use a fixed size copy so the compiler can turn the loop into plain (or vector) moves.
+  static void gather(const unsigned char* source, SIZE_T stride, SIZE_T count, SIZE_T elementSize, unsigned char* output) {
+    switch (elementSize) {
+      case 1:
+        for (SIZE_T i = 0; i < count; i++) output[i] = source[i * stride];
+        break;
+      case 4:
+        for (SIZE_T i = 0; i < count; i++) memcpy(output + i * 4, source + i * stride, 4);
+        break;
+      case 8:
+        for (SIZE_T i = 0; i < count; i++) memcpy(output + i * 8, source + i * stride, 8);
+        break;
+      default:
+        for (SIZE_T i = 0; i < count; i++) memcpy(output + i * elementSize, source + i * stride, elementSize);
+        break;
+    }
+  }
+
+  // Reads a null-terminated string in blocks that never cross a page boundary (so a string that ends
+  // right before an unreadable page can still be read). The string is stored in the scratch arena.
+  // Returns false if the string couldn't be read or has no terminator within maxLength chars.
+  static bool readString(HANDLE hProcess, DWORD64 dwAddress, SIZE_T maxLength, arena& scratch, const char** value, SIZE_T* length) {
+    const SIZE_T pageSize = 0x1000;
+
+    char* chars = nullptr;
+    SIZE_T capacity = 0;
+    SIZE_T size = 0;
+
+    while (size <= maxLength) {
+      SIZE_T block = pageSize - (SIZE_T)((dwAddress + size) & (pageSize - 1));
+
+      if (size + block > capacity) {
+        SIZE_T newCapacity = capacity * 2 > size + block ? capacity * 2 : size + block;
+        char* grown = (char*)scratch.allocate(newCapacity);
+        if (size > 0) memcpy(grown, chars, size);
+        chars = grown;
+        capacity = newCapacity;
+      }
+
+      if (!readBuffer(hProcess, dwAddress + size, chars + size, block)) return false;
+
+      const char* terminator = (const char*)memchr(chars + size, '\0', block);
+
+      if (terminator != nullptr) {
+        *value = chars;
+        *length = terminator - chars;
+        return *length <= maxLength;
+      }
+
+      size += block;
+    }
+
+    return false;
+  }
+
   char readMemoryChar(HANDLE hProcess, DWORD64 dwAddress) {
     char value;
     ReadProcessMemory(hProcess, (LPVOID)dwAddress, &value, sizeof(char), NULL);
@@ -32,7 +172,7 @@ public:
 	}
 
   template <class dataType>
-  void writeMemory(HANDLE hProcess, DWORD64 dwAddress, dataType value) {
+  static void writeMemory(HANDLE hProcess, DWORD64 dwAddress, dataType value) {
     WriteProcessMemory(hProcess, (LPVOID)dwAddress, &value, sizeof(dataType), NULL);
   }
 
@@ -1,14 +1,24 @@
 #include <node.h>
 #include <windows.h>
 #include <TlHelp32.h>
+#include <algorithm>
 #include <string>
 #include <vector>
+#include <limits>
+#include <unordered_map>
 #include <iostream>
 #include "module.h"
 #include "process.h"
 #include "memoryjs.h"
 #include "memory.h"
 #include "pattern.h"
+#include "gather.h"
+#include "scancontrol.h"
+#include "signature.h"
+#include "scheduler.h"
+#include "stringscan.h"
+#include "recorder.h"
+#include "instance.h"
 
 using v8::Exception;
 using v8::Function;
@@ -23,11 +33,6 @@ using v8::Handle;
 using v8::Array;
 using v8::Boolean;
 
-process Process;
-module Module;
-memory Memory;
-pattern Pattern;
-
 struct Vector3 {
   float x, y, z;
 };
@@ -43,8 +48,76 @@ void memoryjs::throwError(char* error, Isolate* isolate) {
   return;
 }
 
+// Pointer to the first byte of a TypedArray/DataView's contents
+void* memoryjs::getViewData(v8::Local<v8::ArrayBufferView> view) {
+#if V8_MAJOR_VERSION >= 8
+  char* data = static_cast<char*>(view->Buffer()->GetBackingStore()->Data());
+#else
+  char* data = static_cast<char*>(view->Buffer()->GetContents().Data());
+#endif
+  return data + view->ByteOffset();
+}
+
+// Data types that can be read into a TypedArray
+enum ArrayType {
+  ARRAY_INVALID,
+  ARRAY_INT,
+  ARRAY_DWORD,
+  ARRAY_FLOAT,
+  ARRAY_DOUBLE,
+  ARRAY_BOOL,
+  ARRAY_PTR
+};
+
+ArrayType getArrayType(const char* dataType) {
+  if (!strcmp(dataType, "int") || !strcmp(dataType, "long")) return ARRAY_INT;
+  if (!strcmp(dataType, "dword")) return ARRAY_DWORD;
+  if (!strcmp(dataType, "float")) return ARRAY_FLOAT;
+  if (!strcmp(dataType, "double")) return ARRAY_DOUBLE;
+  if (!strcmp(dataType, "bool") || !strcmp(dataType, "boolean")) return ARRAY_BOOL;
+  if (!strcmp(dataType, "ptr") || !strcmp(dataType, "pointer")) return ARRAY_PTR;
+  return ARRAY_INVALID;
+}
+
+// Size of an element in the target process' memory
+SIZE_T getArrayTypeSize(ArrayType arrayType) {
+  switch (arrayType) {
+    case ARRAY_INT: return sizeof(int);
+    case ARRAY_DWORD: return sizeof(DWORD);
+    case ARRAY_FLOAT: return sizeof(float);
+    case ARRAY_DOUBLE: return sizeof(double);
+    case ARRAY_BOOL: return sizeof(bool);
+    case ARRAY_PTR: return sizeof(intptr_t);
+    default: return 0;
+  }
+}
+
+// Pointers are handed to JavaScript as doubles (Float64Array), every other type is stored as is
+bool isTypedArrayOf(Local<Value> value, ArrayType arrayType) {
+  switch (arrayType) {
+    case ARRAY_INT: return value->IsInt32Array();
+    case ARRAY_DWORD: return value->IsUint32Array();
+    case ARRAY_FLOAT: return value->IsFloat32Array();
+    case ARRAY_DOUBLE: return value->IsFloat64Array();
+    case ARRAY_BOOL: return value->IsUint8Array();
+    case ARRAY_PTR: return value->IsFloat64Array();
+    default: return false;
+  }
+}
+
+Local<v8::TypedArray> createTypedArray(Isolate* isolate, ArrayType arrayType, size_t count) {
+  switch (arrayType) {
+    case ARRAY_INT: return v8::Int32Array::New(v8::ArrayBuffer::New(isolate, count * sizeof(int32_t)), 0, count);
+    case ARRAY_DWORD: return v8::Uint32Array::New(v8::ArrayBuffer::New(isolate, count * sizeof(uint32_t)), 0, count);
+    case ARRAY_FLOAT: return v8::Float32Array::New(v8::ArrayBuffer::New(isolate, count * sizeof(float)), 0, count);
+    case ARRAY_BOOL: return v8::Uint8Array::New(v8::ArrayBuffer::New(isolate, count * sizeof(uint8_t)), 0, count);
+    default: return v8::Float64Array::New(v8::ArrayBuffer::New(isolate, count * sizeof(double)), 0, count);
+  }
+}
+
 void openProcess(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
   
   if (args.Length() != 1 && args.Length() != 2) {
     memoryjs::throwError("requires 1 argument, or 2 arguments if a callback is being used", isolate);
@@ -68,20 +141,20 @@ void openProcess(const FunctionCallbackInfo<Value>& args) {
 
   if (args[0]->IsString()) {
     v8::String::Utf8Value processName(args[0]);  
-    pair = Process.openProcess((char*) *(processName), &errorMessage);
+    pair = addon->Process.openProcess((char*) *(processName), &errorMessage);
 
     // In case it failed to open, let's keep retrying
     // while(!strcmp(process.szExeFile, "")) {
-    //   process = Process.openProcess((char*) *(processName), &errorMessage);
+    //   process = addon->Process.openProcess((char*) *(processName), &errorMessage);
     // };
   }
 
   if (args[0]->IsNumber()) {
-    pair = Process.openProcess(args[0]->Uint32Value(), &errorMessage);
+    pair = addon->Process.openProcess(args[0]->Uint32Value(), &errorMessage);
 
     // In case it failed to open, let's keep retrying
     // while(!strcmp(process.szExeFile, "")) {
-    //   process = Process.openProcess(args[0]->Uint32Value(), &errorMessage);
+    //   process = addon->Process.openProcess(args[0]->Uint32Value(), &errorMessage);
     // };
   }
 
@@ -103,7 +176,7 @@ void openProcess(const FunctionCallbackInfo<Value>& args) {
   processInfo->Set(String::NewFromUtf8(isolate, "szExeFile"), String::NewFromUtf8(isolate, pair.process.szExeFile));
   processInfo->Set(String::NewFromUtf8(isolate, "handle"), Number::New(isolate, (int)pair.handle));
 
-  DWORD base = Module.getBaseAddress(pair.process.szExeFile, pair.process.th32ProcessID);
+  DWORD base = addon->Module.getBaseAddress(pair.process.szExeFile, pair.process.th32ProcessID);
   processInfo->Set(String::NewFromUtf8(isolate, "modBaseAddr"), Number::New(isolate, (uintptr_t)base));
 
   // openProcess can either take one argument or can take
@@ -122,6 +195,7 @@ void openProcess(const FunctionCallbackInfo<Value>& args) {
 
 void closeProcess(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
 
   if (args.Length() != 1) {
     memoryjs::throwError("requires 1 argument", isolate);
@@ -133,11 +207,12 @@ void closeProcess(const FunctionCallbackInfo<Value>& args) {
     return;
   }
 
-  Process.closeProcess((HANDLE)args[0]->Int32Value());
+  addon->Process.closeProcess((HANDLE)args[0]->Int32Value());
 }
 
 void getProcesses(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
 
   if (args.Length() > 1) {
     memoryjs::throwError("requires either 0 arguments or 1 argument if a callback is being used", isolate);
@@ -152,7 +227,7 @@ void getProcesses(const FunctionCallbackInfo<Value>& args) {
   // Define error message that may be set by the function that gets the processes
   char* errorMessage = "";
 
-  std::vector<PROCESSENTRY32> processEntries = Process.getProcesses(&errorMessage);
+  std::vector<PROCESSENTRY32> processEntries = addon->Process.getProcesses(&errorMessage);
 
   // If an error message was returned from the function that gets the processes, throw the error.
   // Only throw an error if there is no callback (if there's a callback, the error is passed there).
@@ -167,13 +242,14 @@ void getProcesses(const FunctionCallbackInfo<Value>& args) {
   // Loop over all processes found
   for (std::vector<PROCESSENTRY32>::size_type i = 0; i != processEntries.size(); i++) {
     // Create a v8 object to store the current process' information
-    Local<Object> process = Object::New(isolate);
+    // (from a template and with cached property names, so every object has the same shape)
+    Local<Object> process = addon->newProcessObject();
 
-    process->Set(String::NewFromUtf8(isolate, "cntThreads"), Number::New(isolate, (int)processEntries[i].cntThreads));
-    process->Set(String::NewFromUtf8(isolate, "szExeFile"), String::NewFromUtf8(isolate, processEntries[i].szExeFile));
-    process->Set(String::NewFromUtf8(isolate, "th32ProcessID"), Number::New(isolate, (int)processEntries[i].th32ProcessID));
-    process->Set(String::NewFromUtf8(isolate, "th32ParentProcessID"), Number::New(isolate, (int)processEntries[i].th32ParentProcessID));
-    process->Set(String::NewFromUtf8(isolate, "pcPriClassBase"), Number::New(isolate, (int)processEntries[i].pcPriClassBase));
+    process->Set(addon->key(instance::KEY_CNT_THREADS), Number::New(isolate, (int)processEntries[i].cntThreads));
+    process->Set(addon->key(instance::KEY_SZ_EXE_FILE), String::NewFromUtf8(isolate, processEntries[i].szExeFile));
+    process->Set(addon->key(instance::KEY_TH32_PROCESS_ID), Number::New(isolate, (int)processEntries[i].th32ProcessID));
+    process->Set(addon->key(instance::KEY_TH32_PARENT_PROCESS_ID), Number::New(isolate, (int)processEntries[i].th32ParentProcessID));
+    process->Set(addon->key(instance::KEY_PC_PRI_CLASS_BASE), Number::New(isolate, (int)processEntries[i].pcPriClassBase));
 
     // Push the object to the array
     processes->Set(i, process);
@@ -195,6 +271,7 @@ void getProcesses(const FunctionCallbackInfo<Value>& args) {
 
 void getModules(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
 
   if (args.Length() != 1 && args.Length() != 2) {
     memoryjs::throwError("requires 1 argument, or 2 arguments if a callback is being used", isolate);
@@ -214,7 +291,7 @@ void getModules(const FunctionCallbackInfo<Value>& args) {
   // Define error message that may be set by the function that gets the modules
   char* errorMessage = "";
 
-  std::vector<MODULEENTRY32> moduleEntries = Module.getModules(args[0]->Int32Value(), &errorMessage);
+  std::vector<MODULEENTRY32> moduleEntries = addon->Module.getModules(args[0]->Int32Value(), &errorMessage);
 
   // If an error message was returned from the function getting the modules, throw the error.
   // Only throw an error if there is no callback (if there's a callback, the error is passed there).
@@ -230,13 +307,14 @@ void getModules(const FunctionCallbackInfo<Value>& args) {
   // Loop over all modules found
   for (std::vector<MODULEENTRY32>::size_type i = 0; i != moduleEntries.size(); i++) {
     //  Create a v8 object to store the current module's information
-    Local<Object> module = Object::New(isolate);
+    // (from a template and with cached property names, so every object has the same shape)
+    Local<Object> module = addon->newModuleObject();
 
-    module->Set(String::NewFromUtf8(isolate, "modBaseAddr"), Number::New(isolate, (uintptr_t)moduleEntries[i].modBaseAddr));
-    module->Set(String::NewFromUtf8(isolate, "modBaseSize"), Number::New(isolate, (int)moduleEntries[i].modBaseSize));
-    module->Set(String::NewFromUtf8(isolate, "szExePath"), String::NewFromUtf8(isolate, moduleEntries[i].szExePath));
-    module->Set(String::NewFromUtf8(isolate, "szModule"), String::NewFromUtf8(isolate, moduleEntries[i].szModule));
-    module->Set(String::NewFromUtf8(isolate, "th32ModuleID"), Number::New(isolate, (int)moduleEntries[i].th32ProcessID));
+    module->Set(addon->key(instance::KEY_MOD_BASE_ADDR), Number::New(isolate, (uintptr_t)moduleEntries[i].modBaseAddr));
+    module->Set(addon->key(instance::KEY_MOD_BASE_SIZE), Number::New(isolate, (int)moduleEntries[i].modBaseSize));
+    module->Set(addon->key(instance::KEY_SZ_EXE_PATH), String::NewFromUtf8(isolate, moduleEntries[i].szExePath));
+    module->Set(addon->key(instance::KEY_SZ_MODULE), String::NewFromUtf8(isolate, moduleEntries[i].szModule));
+    module->Set(addon->key(instance::KEY_TH32_MODULE_ID), Number::New(isolate, (int)moduleEntries[i].th32ProcessID));
 
     // Push the object to the array
     modules->Set(i, module);
@@ -256,8 +334,133 @@ void getModules(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Builds a table of unique strings (as an array) and returns the index of each string in it
+class stringtable {
+public:
+  stringtable(Isolate* isolate) : isolate(isolate), strings(Array::New(isolate)) {}
+
+  uint32_t intern(const char* value) {
+    std::unordered_map<std::string, uint32_t>::iterator found = indices.find(value);
+    if (found != indices.end()) return found->second;
+
+    uint32_t index = (uint32_t)indices.size();
+    indices[value] = index;
+    strings->Set(index, String::NewFromUtf8(isolate, value, v8::NewStringType::kInternalized).ToLocalChecked());
+    return index;
+  }
+
+  Isolate* isolate;
+  Local<Array> strings;
+  std::unordered_map<std::string, uint32_t> indices;
+};
+
+// Columnar version of getProcesses: one TypedArray per field, names are indices into a string table
+void getProcessTable(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  char* errorMessage = "";
+
+  std::vector<PROCESSENTRY32> processEntries = addon->Process.getProcesses(&errorMessage);
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  size_t count = processEntries.size();
+  Local<v8::TypedArray> cntThreads = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> processId = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> parentProcessId = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> priorityBase = createTypedArray(isolate, ARRAY_INT, count);
+  Local<v8::TypedArray> exeFile = createTypedArray(isolate, ARRAY_DWORD, count);
+
+  uint32_t* cntThreadsData = static_cast<uint32_t*>(memoryjs::getViewData(cntThreads));
+  uint32_t* processIdData = static_cast<uint32_t*>(memoryjs::getViewData(processId));
+  uint32_t* parentProcessIdData = static_cast<uint32_t*>(memoryjs::getViewData(parentProcessId));
+  int32_t* priorityBaseData = static_cast<int32_t*>(memoryjs::getViewData(priorityBase));
+  uint32_t* exeFileData = static_cast<uint32_t*>(memoryjs::getViewData(exeFile));
+
+  stringtable strings(isolate);
+
+  for (size_t i = 0; i < count; i++) {
+    cntThreadsData[i] = processEntries[i].cntThreads;
+    processIdData[i] = processEntries[i].th32ProcessID;
+    parentProcessIdData[i] = processEntries[i].th32ParentProcessID;
+    priorityBaseData[i] = processEntries[i].pcPriClassBase;
+    exeFileData[i] = strings.intern(processEntries[i].szExeFile);
+  }
+
+  Local<Object> table = Object::New(isolate);
+  table->Set(addon->key(instance::KEY_LENGTH), Number::New(isolate, (double)count));
+  table->Set(addon->key(instance::KEY_CNT_THREADS), cntThreads);
+  table->Set(addon->key(instance::KEY_TH32_PROCESS_ID), processId);
+  table->Set(addon->key(instance::KEY_TH32_PARENT_PROCESS_ID), parentProcessId);
+  table->Set(addon->key(instance::KEY_PC_PRI_CLASS_BASE), priorityBase);
+  table->Set(addon->key(instance::KEY_SZ_EXE_FILE), exeFile);
+  table->Set(addon->key(instance::KEY_STRINGS), strings.strings);
+
+  args.GetReturnValue().Set(table);
+}
+
+// Columnar version of getModules
+void getModuleTable(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 1 || !args[0]->IsNumber()) {
+    memoryjs::throwError("requires 1 argument, a number", isolate);
+    return;
+  }
+
+  char* errorMessage = "";
+
+  std::vector<MODULEENTRY32> moduleEntries = addon->Module.getModules(args[0]->Int32Value(), &errorMessage);
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  size_t count = moduleEntries.size();
+  Local<v8::TypedArray> baseAddress = createTypedArray(isolate, ARRAY_DOUBLE, count);
+  Local<v8::TypedArray> baseSize = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> exePath = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> moduleName = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> processId = createTypedArray(isolate, ARRAY_DWORD, count);
+
+  double* baseAddressData = static_cast<double*>(memoryjs::getViewData(baseAddress));
+  uint32_t* baseSizeData = static_cast<uint32_t*>(memoryjs::getViewData(baseSize));
+  uint32_t* exePathData = static_cast<uint32_t*>(memoryjs::getViewData(exePath));
+  uint32_t* moduleNameData = static_cast<uint32_t*>(memoryjs::getViewData(moduleName));
+  uint32_t* processIdData = static_cast<uint32_t*>(memoryjs::getViewData(processId));
+
+  stringtable strings(isolate);
+
+  for (size_t i = 0; i < count; i++) {
+    baseAddressData[i] = (double)(uintptr_t)moduleEntries[i].modBaseAddr;
+    baseSizeData[i] = moduleEntries[i].modBaseSize;
+    exePathData[i] = strings.intern(moduleEntries[i].szExePath);
+    moduleNameData[i] = strings.intern(moduleEntries[i].szModule);
+    processIdData[i] = moduleEntries[i].th32ProcessID;
+  }
+
+  Local<Object> table = Object::New(isolate);
+  table->Set(addon->key(instance::KEY_LENGTH), Number::New(isolate, (double)count));
+  table->Set(addon->key(instance::KEY_MOD_BASE_ADDR), baseAddress);
+  table->Set(addon->key(instance::KEY_MOD_BASE_SIZE), baseSize);
+  table->Set(addon->key(instance::KEY_SZ_EXE_PATH), exePath);
+  table->Set(addon->key(instance::KEY_SZ_MODULE), moduleName);
+  // same key as the module objects of getModules, which have always named the process id th32ModuleID
+  table->Set(addon->key(instance::KEY_TH32_MODULE_ID), processId);
+  table->Set(addon->key(instance::KEY_STRINGS), strings.strings);
+
+  args.GetReturnValue().Set(table);
+}
+
 void findModule(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
 
   if (args.Length() != 1 && args.Length() != 2 && args.Length() != 3) {
     memoryjs::throwError("requires 1 argument, 2 arguments, or 3 arguments if a callback is being used", isolate);
@@ -279,7 +482,7 @@ void findModule(const FunctionCallbackInfo<Value>& args) {
   // Define error message that may be set by the function that gets the modules
   char* errorMessage = "";
 
-  MODULEENTRY32 module = Module.findModule((char*) *(moduleName), args[1]->Int32Value(), &errorMessage);
+  MODULEENTRY32 module = addon->Module.findModule((char*) *(moduleName), args[1]->Int32Value(), &errorMessage);
 
   // If an error message was returned from the function getting the module, throw the error.
   // Only throw an error if there is no callback (if there's a callback, the error is passed there).
@@ -290,7 +493,7 @@ void findModule(const FunctionCallbackInfo<Value>& args) {
 
   // In case it failed to open, let's keep retrying
   while (!strcmp(module.szExePath, "")) {
-    module = Module.findModule((char*) *(moduleName), args[1]->Int32Value(), &errorMessage);
+    module = addon->Module.findModule((char*) *(moduleName), args[1]->Int32Value(), &errorMessage);
   };
 
   // Create a v8 Object (JSON) to store the process information
@@ -319,8 +522,7 @@ void findModule(const FunctionCallbackInfo<Value>& args) {
 
 void readMemory(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
-
-  std::cout<< args.Length() << std::endl;
+  instance* addon = instance::get(args);
 
   if (args.Length() != 3 && args.Length() != 4) {
     memoryjs::throwError("requires 3 arguments, or 4 arguments if a callback is being used", isolate);
@@ -353,85 +555,69 @@ void readMemory(const FunctionCallbackInfo<Value>& args) {
   // args[1] -> Uint32Value() is the address to read
   if (!strcmp(dataType, "int")) {
 
-    int result = Memory.readMemory<int>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
+    int result = addon->Memory.readMemory<int>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
     if (args.Length() == 4) argv[1] = Number::New(isolate, result);
     else args.GetReturnValue().Set(Number::New(isolate, result));
 
   } else if (!strcmp(dataType, "dword")) {
 
-    DWORD result = Memory.readMemory<DWORD>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
+    DWORD result = addon->Memory.readMemory<DWORD>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
     if (args.Length() == 4) argv[1] = Number::New(isolate, result);
     else args.GetReturnValue().Set(Number::New(isolate, result));
 
   } else if (!strcmp(dataType, "long")) {
 
-    long result = Memory.readMemory<long>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
+    long result = addon->Memory.readMemory<long>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
     if (args.Length() == 4) argv[1] = Number::New(isolate, result);
     else args.GetReturnValue().Set(Number::New(isolate, result));
 
   } else if (!strcmp(dataType, "float")) {
 
-    float result = Memory.readMemory<float>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
+    float result = addon->Memory.readMemory<float>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
     if (args.Length() == 4) argv[1] = Number::New(isolate, result);
     else args.GetReturnValue().Set(Number::New(isolate, result));
 
   } else if (!strcmp(dataType, "double")) {
 		
-    double result = Memory.readMemory<double>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
+    double result = addon->Memory.readMemory<double>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
     if (args.Length() == 4) argv[1] = Number::New(isolate, result);
     else args.GetReturnValue().Set(Number::New(isolate, result));
 
   } else if (!strcmp(dataType, "ptr") || !strcmp(dataType, "pointer")) {
 
-    intptr_t result = Memory.readMemory<intptr_t>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
+    intptr_t result = addon->Memory.readMemory<intptr_t>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
     if (args.Length() == 4) argv[1] = Number::New(isolate, result);
     else args.GetReturnValue().Set(Number::New(isolate, result));
 
   } else if (!strcmp(dataType, "bool") || !strcmp(dataType, "boolean")) {
 
-    bool result = Memory.readMemory<bool>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
+    bool result = addon->Memory.readMemory<bool>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
     if (args.Length() == 4) argv[1] = Boolean::New(isolate, result);
     else args.GetReturnValue().Set(Boolean::New(isolate, result));
 
   } else if (!strcmp(dataType, "string") || !strcmp(dataType, "str")) {
 
-    std::vector<char> chars;
-    int offset = 0x0;
-    while (true) {
-      char c = Memory.readMemoryChar((HANDLE)args[0]->Uint32Value(), args[1]->IntegerValue() + offset);
-      chars.push_back(c);
-
-      // break at 1 million chars
-      if (offset == (sizeof(char) * 1000000)) {
-        chars.clear();
-        break;
-      }
-
-      // break at terminator
-      if (c == '\0') {
-        break;
-      }
+    const char* value;
+    SIZE_T length;
 
-      offset += sizeof(char);
-    }
+    // the string is decoded into the instance's scratch arena, which is reset for every read
+    addon->Scratch.reset();
 
-    if (chars.size() == 0) {
+    if (!addon->Memory.readString((HANDLE)args[0]->Uint32Value(), args[1]->IntegerValue(), 1000000, addon->Scratch, &value, &length)) {
     
       if (args.Length() == 4) argv[0] = String::NewFromUtf8(isolate, "unable to read string (no null-terminator found after 1 million chars)");
       else return memoryjs::throwError("unable to read string (no null-terminator found after 1 million chars)", isolate);
     
     } else {
-      // vector -> string
-      std::string str(chars.begin(), chars.end());
 
-      if (args.Length() == 4) argv[1] = String::NewFromUtf8(isolate, str.c_str());
-      else args.GetReturnValue().Set(String::NewFromUtf8(isolate, str.c_str()));
+      if (args.Length() == 4) argv[1] = String::NewFromUtf8(isolate, value, v8::String::kNormalString, (int)length);
+      else args.GetReturnValue().Set(String::NewFromUtf8(isolate, value, v8::String::kNormalString, (int)length));
     
     }
 
   } else if (!strcmp(dataType, "vector3") || !strcmp(dataType, "vec3")) {
 
-    Vector3 result = Memory.readMemory<Vector3>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
+    Vector3 result = addon->Memory.readMemory<Vector3>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
     Local<Object> moduleInfo = Object::New(isolate);
     moduleInfo->Set(String::NewFromUtf8(isolate, "x"), Number::New(isolate, result.x));
     moduleInfo->Set(String::NewFromUtf8(isolate, "y"), Number::New(isolate, result.y));
@@ -442,7 +628,7 @@ void readMemory(const FunctionCallbackInfo<Value>& args) {
 
   } else if (!strcmp(dataType, "vector4") || !strcmp(dataType, "vec4")) {
     
-    Vector4 result = Memory.readMemory<Vector4>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
+    Vector4 result = addon->Memory.readMemory<Vector4>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value());
     Local<Object> moduleInfo = Object::New(isolate);
     moduleInfo->Set(String::NewFromUtf8(isolate, "w"), Number::New(isolate, result.w));
     moduleInfo->Set(String::NewFromUtf8(isolate, "x"), Number::New(isolate, result.x));
@@ -466,6 +652,7 @@ void readMemory(const FunctionCallbackInfo<Value>& args) {
 
 void writeMemory(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
 
   if (args.Length() != 4) {
     memoryjs::throwError("requires 4 arguments", isolate);
@@ -493,37 +680,37 @@ void writeMemory(const FunctionCallbackInfo<Value>& args) {
   // args[1] -> value is the value to write to the address
   if (!strcmp(dataType, "int")) {
 
-    Memory.writeMemory<int>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
+    addon->Memory.writeMemory<int>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
 
   } else if (!strcmp(dataType, "dword")) {
 
-    Memory.writeMemory<DWORD>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
+    addon->Memory.writeMemory<DWORD>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
 
   } else if (!strcmp(dataType, "long")) {
 
-    Memory.writeMemory<long>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
+    addon->Memory.writeMemory<long>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
 
   } else if (!strcmp(dataType, "float")) {
 
-    Memory.writeMemory<float>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
+    addon->Memory.writeMemory<float>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
 
   } else if (!strcmp(dataType, "double")) {
 
-    Memory.writeMemory<double>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
+    addon->Memory.writeMemory<double>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->NumberValue());
 
   } else if (!strcmp(dataType, "bool") || !strcmp(dataType, "boolean")) {
 
-    Memory.writeMemory<bool>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->BooleanValue());
+    addon->Memory.writeMemory<bool>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), args[2]->BooleanValue());
 
   } else if (!strcmp(dataType, "string") || !strcmp(dataType, "str")) {
 
     v8::String::Utf8Value valueParam(args[2]->ToString());
     
     // Write String, Method 1
-    //Memory.writeMemory<std::string>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), std::string(*valueParam));
+    //addon->Memory.writeMemory<std::string>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), std::string(*valueParam));
 
     // Write String, Method 2
-    Memory.writeMemory((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), *valueParam, valueParam.length());
+    addon->Memory.writeMemory((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), *valueParam, valueParam.length());
     
   } else if (!strcmp(dataType, "vector3") || !strcmp(dataType, "vec3")) {
 
@@ -533,7 +720,7 @@ void writeMemory(const FunctionCallbackInfo<Value>& args) {
       value->Get(String::NewFromUtf8(isolate, "y"))->NumberValue(),
       value->Get(String::NewFromUtf8(isolate, "z"))->NumberValue()
     };
-    Memory.writeMemory<Vector3>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), vector);
+    addon->Memory.writeMemory<Vector3>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), vector);
 
   } else if (!strcmp(dataType, "vector4") || !strcmp(dataType, "vec4")) {
 
@@ -544,7 +731,7 @@ void writeMemory(const FunctionCallbackInfo<Value>& args) {
       value->Get(String::NewFromUtf8(isolate, "y"))->NumberValue(),
       value->Get(String::NewFromUtf8(isolate, "z"))->NumberValue()
     };
-    Memory.writeMemory<Vector4>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), vector);
+    addon->Memory.writeMemory<Vector4>((HANDLE)args[0]->Uint32Value(), args[1]->Uint32Value(), vector);
 
   } else {
 
@@ -557,37 +744,176 @@ void writeMemory(const FunctionCallbackInfo<Value>& args) {
   if (args.Length() == 5) callback->Call(Null(isolate), argc, argv);
 }
 
+// Reads an optional number from an options object
+double getOption(Isolate* isolate, Local<Object> options, const char* name, double defaultValue) {
+  Local<Value> value = options->Get(String::NewFromUtf8(isolate, name));
+  return value->IsNumber() ? value->NumberValue() : defaultValue;
+}
+
+// Applies the cancelFlag, timeout and onProgress options of a scan to control.
+// onProgress is called synchronously from the scanning thread, so it must not be used after the function returns.
+bool setScanControl(Isolate* isolate, Local<Object> options, scancontrol& control) {
+  Local<Value> cancelFlag = options->Get(String::NewFromUtf8(isolate, "cancelFlag"));
+  Local<Value> onProgress = options->Get(String::NewFromUtf8(isolate, "onProgress"));
+
+  if (!cancelFlag->IsUndefined()) {
+    if (!cancelFlag->IsInt32Array() || Local<v8::Int32Array>::Cast(cancelFlag)->Length() < 1) {
+      memoryjs::throwError("cancelFlag must be an Int32Array", isolate);
+      return false;
+    }
+
+    control.setCancelFlag(static_cast<volatile int32_t*>(memoryjs::getViewData(Local<v8::Int32Array>::Cast(cancelFlag))));
+  }
+
+  double timeout = getOption(isolate, options, "timeout", -1);
+  if (timeout >= 0) control.setTimeout(timeout);
+
+  if (!onProgress->IsUndefined()) {
+    if (!onProgress->IsFunction()) {
+      memoryjs::throwError("onProgress must be a function", isolate);
+      return false;
+    }
+
+    Local<Function> callback = Local<Function>::Cast(onProgress);
+
+    control.setProgressCallback([isolate, callback](const scancontrol::Progress& progress) {
+      Local<Object> info = Object::New(isolate);
+      info->Set(String::NewFromUtf8(isolate, "bytesScanned"), Number::New(isolate, (double)progress.bytesScanned));
+      info->Set(String::NewFromUtf8(isolate, "bytesTotal"), Number::New(isolate, (double)progress.bytesTotal));
+      info->Set(String::NewFromUtf8(isolate, "elapsed"), Number::New(isolate, progress.elapsed));
+      info->Set(String::NewFromUtf8(isolate, "eta"), Number::New(isolate, progress.eta));
+
+      const unsigned argc = 1;
+      Local<Value> argv[argc] = { info };
+      callback->Call(Null(isolate), argc, argv);
+    }, getOption(isolate, options, "progressInterval", 100));
+  }
+
+  return true;
+}
+
+// sections is either left out, a string or a non-empty array of strings, anything else would silently scan the default ranges
+bool checkPatternSections(Local<Value> sections, char** errorMessage) {
+  if (sections->IsUndefined() || sections->IsString()) return true;
+
+  if (sections->IsArray()) {
+    Local<Array> sectionArray = Local<Array>::Cast(sections);
+    bool valid = sectionArray->Length() > 0;
+
+    for (unsigned int i = 0; valid && i < sectionArray->Length(); i++) {
+      valid = sectionArray->Get(i)->IsString();
+    }
+
+    if (valid) return true;
+  }
+
+  *errorMessage = "sections must be a string or a non-empty array of strings";
+  return false;
+}
+
+// Selects the parts of a module findPattern scans. sections can be 'all' (the whole module), 'code' (the executable
+// sections), the name of a section or an array of names. By default the executable sections are scanned first
+// and the rest of the module only if there's no match in them, so data signatures are still found.
+bool getPatternRanges(instance* addon, HANDLE handle, const MODULEENTRY32& module, Local<Value> sections,
+  std::vector<reader::Range>& ranges, std::vector<reader::Range>& fallbackRanges, char** errorMessage) {
+  reader::Range wholeModule = { (uintptr_t)module.hModule, module.modBaseSize };
+  std::vector<std::string> names;
+
+  if (sections->IsArray()) {
+    Local<Array> sectionArray = Local<Array>::Cast(sections);
+
+    for (unsigned int i = 0; i < sectionArray->Length(); i++) {
+      v8::String::Utf8Value name(sectionArray->Get(i));
+      names.push_back(*name);
+    }
+  } else if (sections->IsString()) {
+    v8::String::Utf8Value name(sections);
+
+    if (!strcmp(*name, "all")) {
+      ranges.push_back(wholeModule);
+      return true;
+    }
+
+    if (strcmp(*name, "code")) names.push_back(*name);
+  }
+
+  bool selected = sections->IsArray() || sections->IsString();
+  image::Info* info = addon->Image.getInfo(handle, module.szModule, addon->Module, errorMessage);
+
+  if (info == nullptr) {
+    if (selected) return false;
+
+    // modules without readable headers are scanned as a whole, like before sections were used
+    *errorMessage = "";
+    ranges.push_back(wholeModule);
+    return true;
+  }
+
+  ranges = image::getSectionRanges(*info, names);
+
+  if (selected) {
+    if (ranges.empty()) *errorMessage = "unable to find section";
+    return !ranges.empty();
+  }
+
+  if (ranges.empty()) {
+    ranges.push_back(wholeModule);
+  } else {
+    fallbackRanges = image::getRemainingRanges(*info, ranges);
+  }
+
+  return true;
+}
+
 void findPattern(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() < 6 || args.Length() > 8) {
+    memoryjs::throwError("requires 6 arguments, followed by optional options and callback arguments", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsString() || !args[2]->IsString() || !args[3]->IsNumber() || !args[4]->IsNumber() || !args[5]->IsNumber()) {
+    memoryjs::throwError("first argument must be a number, second and third arguments must be strings, the remaining arguments must be numbers", isolate);
+    return;
+  }
 
-  // if (args.Length() != 5 && args.Length() != 6) {
-  //   memoryjs::throwError("requires 5 arguments, or 6 arguments if a callback is being used", isolate);
-  //   return;
-  // }
+  // The options object and callback are both optional, the callback is always last
+  bool hasOptions = args.Length() > 6 && args[6]->IsObject() && !args[6]->IsFunction();
+  bool hasCallback = args[args.Length() - 1]->IsFunction();
 
-  // if (!args[0]->IsNumber() && !args[1]->IsString() && !args[2]->IsNumber() && !args[3]->IsNumber() && !args[4]->IsNumber()) {
-  //   memoryjs::throwError("first argument must be a number, the remaining arguments must be numbers apart from the callback", isolate);
-  //   return;
-  // }
+  if (args.Length() == 8 && !(hasOptions && hasCallback)) {
+    memoryjs::throwError("seventh argument must be an object and eighth argument must be a function", isolate);
+    return;
+  }
 
-  // if (args.Length() == 6 && !args[5]->IsFunction()) {
-  //   memoryjs::throwError("sixth argument must be a function", isolate);
-  //   return;
-  // }
+  scancontrol control;
+  if (hasOptions && !setScanControl(isolate, args[6]->ToObject(), control)) return;
 
   // Address of findPattern result
   uintptr_t address = -1;
+  bool complete = true;
+  std::vector<uintptr_t> captures;
 
   // Define error message that may be set by the function that gets the modules
   char* errorMessage = "";
 
+  // The signature is compiled before the scan, a malformed signature is reported like any other error
+  signature sig;
+  v8::String::Utf8Value signatureString(args[2]->ToString());
+
+  bool compiled = sig.compile(*signatureString, &errorMessage);
+
   HANDLE handle = (HANDLE)args[0]->Uint32Value();
+  Local<Value> sections = hasOptions ? args[6]->ToObject()->Get(String::NewFromUtf8(isolate, "sections")) : Local<Value>(v8::Undefined(isolate));
 
-  std::vector<MODULEENTRY32> moduleEntries = Module.getModules(GetProcessId(handle), &errorMessage);
+  std::vector<MODULEENTRY32> moduleEntries;
+  if (compiled && checkPatternSections(sections, &errorMessage)) moduleEntries = addon->Module.getModules(GetProcessId(handle), &errorMessage);
 
-  // If an error message was returned from the function getting the modules, throw the error.
+  // If the signature or the sections are invalid or an error message was returned from the function getting the modules, throw the error.
   // Only throw an error if there is no callback (if there's a callback, the error is passed there).
-  if (strcmp(errorMessage, "") && args.Length() != 7) {
+  if (strcmp(errorMessage, "") && !hasCallback) {
     memoryjs::throwError(errorMessage, isolate);
     return;
   }
@@ -596,40 +922,1150 @@ void findPattern(const FunctionCallbackInfo<Value>& args) {
     v8::String::Utf8Value moduleName(args[1]);
 
     if (!strcmp(moduleEntries[i].szModule, std::string(*moduleName).c_str())) {
-      v8::String::Utf8Value signature(args[2]->ToString());
-      address = Pattern.findPattern(handle, moduleEntries[i], std::string(*signature).c_str(), args[3]->Uint32Value(), args[4]->Uint32Value(), args[5]->Uint32Value());
+      std::vector<reader::Range> ranges;
+      std::vector<reader::Range> fallbackRanges;
+      if (!getPatternRanges(addon, handle, moduleEntries[i], sections, ranges, fallbackRanges, &errorMessage)) break;
+
+      address = addon->Pattern.findPattern(handle, moduleEntries[i], ranges, fallbackRanges, sig, args[3]->Uint32Value(), args[4]->Uint32Value(), args[5]->Uint32Value(),
+        addon->Reader, hasOptions ? &control : nullptr, &complete, &captures);
       break;
     }
   }
 
   // If no error was set by getModules and the address is still the value we set it as, it probably means we couldn't find the module
-  if (strcmp(errorMessage, "") && address == -1) errorMessage = "unable to find module";
+  if (!strcmp(errorMessage, "") && address == -1) errorMessage = "unable to find module";
+
+  // If no error was set by getModules and the address is -2 this means there was no match to the pattern.
+  // A scan that was stopped early is not an error, the result reports it as incomplete.
+  if (!strcmp(errorMessage, "") && address == -2 && complete) errorMessage = "no match found";
+
+  // If the address is -3 an operation of the signature (@rel32, @deref) failed to read memory
+  if (!strcmp(errorMessage, "") && address == -3) errorMessage = "unable to read memory while resolving the signature";
+
+  // If the address is -4 the scan could not allocate a read buffer, this is thrown even without a callback
+  // since it is not a result of the pattern
+  if (!strcmp(errorMessage, "") && address == -4) {
+    errorMessage = "unable to allocate a read buffer";
+
+    if (!hasCallback) {
+      memoryjs::throwError(errorMessage, isolate);
+      return;
+    }
+  }
 
-  // If no error was set by getModules and the address is -2 this means there was no match to the pattern
-  if (strcmp(errorMessage, "") && address == -2) errorMessage = "no match found";
+  // -1 to -4 only say why there is no address, as unsigned values they would turn into huge numbers
+  bool found = address != (uintptr_t)-1 && address != (uintptr_t)-2 && address != (uintptr_t)-3 && address != (uintptr_t)-4;
+  Local<Value> result = found ? Local<Value>(Number::New(isolate, (double)address)) : Local<Value>(Null(isolate));
+
+  // With options, the result also says whether the whole module was scanned
+  if (hasOptions) {
+    scancontrol::Progress progress = control.getProgress();
+    Local<Object> info = Object::New(isolate);
+    info->Set(String::NewFromUtf8(isolate, "address"), result);
+    info->Set(String::NewFromUtf8(isolate, "complete"), Boolean::New(isolate, complete));
+    info->Set(String::NewFromUtf8(isolate, "bytesScanned"), Number::New(isolate, (double)progress.bytesScanned));
+    info->Set(String::NewFromUtf8(isolate, "bytesTotal"), Number::New(isolate, (double)progress.bytesTotal));
+
+    Local<Object> captureInfo = Object::New(isolate);
+    for (std::vector<uintptr_t>::size_type i = 0; i != captures.size(); i++) {
+      captureInfo->Set(String::NewFromUtf8(isolate, sig.captureNames[i].c_str()), Number::New(isolate, (double)captures[i]));
+    }
+
+    info->Set(String::NewFromUtf8(isolate, "captures"), captureInfo);
+    result = info;
+  }
 
   // findPattern can be asynchronous
-  if (args.Length() == 7) {
+  if (hasCallback) {
     // Callback to let the user handle with the information
-    Local<Function> callback = Local<Function>::Cast(args[5]);
+    Local<Function> callback = Local<Function>::Cast(args[args.Length() - 1]);
     const unsigned argc = 2;
-    Local<Value> argv[argc] = { String::NewFromUtf8(isolate, errorMessage), Number::New(isolate, address) };
+    Local<Value> argv[argc] = { String::NewFromUtf8(isolate, errorMessage), result };
     callback->Call(Null(isolate), argc, argv);
   } else {
     // return JSON
-    args.GetReturnValue().Set(Number::New(isolate, address));
+    args.GetReturnValue().Set(result);
+  }
+}
+
+// Shared by readArray and readStrided: `read` fills a packed buffer of count elements (as laid out in the
+// target process) and the result is stored in either the caller's TypedArray (args[outputArg]) or a new one
+template <class Reader>
+void readIntoArray(const FunctionCallbackInfo<Value>& args, ArrayType arrayType, size_t count, int outputArg, Reader read) {
+  Isolate* isolate = args.GetIsolate();
+
+  Local<v8::TypedArray> output;
+
+  if (args.Length() > outputArg && !args[outputArg]->IsUndefined()) {
+    if (!isTypedArrayOf(args[outputArg], arrayType)) {
+      memoryjs::throwError("output array does not match the data type", isolate);
+      return;
+    }
+
+    output = Local<v8::TypedArray>::Cast(args[outputArg]);
+
+    if (output->Length() < count) {
+      memoryjs::throwError("output array is too small", isolate);
+      return;
+    }
+  } else {
+    output = createTypedArray(isolate, arrayType, count);
+  }
+
+  unsigned char* data = static_cast<unsigned char*>(memoryjs::getViewData(output));
+  bool success;
+
+  if (arrayType == ARRAY_PTR) {
+    // pointers are read into the output itself and widened to doubles in place. Pointers are never wider
+    // than doubles, so going from the end no pointer is overwritten before it has been converted.
+    success = count == 0 || read(data);
+
+    for (size_t i = count; success && i-- > 0;) {
+      intptr_t pointer;
+      memcpy(&pointer, data + i * sizeof(intptr_t), sizeof(pointer));
+
+      double value = (double)pointer;
+      memcpy(data + i * sizeof(double), &value, sizeof(value));
+    }
+  } else {
+    success = read(data);
+  }
+
+  if (!success) {
+    memoryjs::throwError("unable to read memory", isolate);
+    return;
+  }
+
+  args.GetReturnValue().Set(output);
+}
+
+void readArray(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 4 && args.Length() != 5) {
+    memoryjs::throwError("requires 4 arguments, or 5 arguments if an output array is being used", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsNumber() || !args[2]->IsString() || !args[3]->IsNumber()) {
+    memoryjs::throwError("first, second and fourth argument must be a number, third argument must be a string", isolate);
+    return;
+  }
+
+  v8::String::Utf8Value dataTypeArg(args[2]);
+  ArrayType arrayType = getArrayType((char*) *(dataTypeArg));
+
+  if (arrayType == ARRAY_INVALID) {
+    memoryjs::throwError("unexpected data type", isolate);
+    return;
+  }
+
+  HANDLE handle = (HANDLE)args[0]->Uint32Value();
+  DWORD64 address = args[1]->IntegerValue();
+  size_t count = args[3]->Uint32Value();
+  SIZE_T size = count * getArrayTypeSize(arrayType);
+
+  readIntoArray(args, arrayType, count, 4, [&](unsigned char* buffer) {
+    return addon->Reader.readInto(handle, address, size, buffer);
+  });
+}
+
+void readStrided(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 6 && args.Length() != 7) {
+    memoryjs::throwError("requires 6 arguments, or 7 arguments if an output array is being used", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsNumber() || !args[2]->IsNumber() || !args[3]->IsNumber() || !args[4]->IsNumber() || !args[5]->IsString()) {
+    memoryjs::throwError("first five arguments must be a number, sixth argument must be a string", isolate);
+    return;
+  }
+
+  v8::String::Utf8Value dataTypeArg(args[5]);
+  ArrayType arrayType = getArrayType((char*) *(dataTypeArg));
+
+  if (arrayType == ARRAY_INVALID) {
+    memoryjs::throwError("unexpected data type", isolate);
+    return;
+  }
+
+  HANDLE handle = (HANDLE)args[0]->Uint32Value();
+  DWORD64 base = args[1]->IntegerValue();
+  SIZE_T stride = args[2]->Uint32Value();
+  size_t count = args[3]->Uint32Value();
+  SIZE_T fieldOffset = args[4]->Uint32Value();
+  SIZE_T elementSize = getArrayTypeSize(arrayType);
+
+  if (stride < elementSize) {
+    memoryjs::throwError("stride must be at least the size of the data type", isolate);
+    return;
+  }
+
+  readIntoArray(args, arrayType, count, 6, [&](unsigned char* buffer) {
+    return addon->Memory.readStrided(handle, base, stride, count, fieldOffset, elementSize, buffer, addon->Pool);
+  });
+}
+
+void gatherFromPointers(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 4) {
+    memoryjs::throwError("requires 4 arguments", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsNumber() || !args[2]->IsNumber() || !args[3]->IsObject()) {
+    memoryjs::throwError("first three arguments must be a number, fourth argument must be an object", isolate);
+    return;
+  }
+
+  HANDLE handle = (HANDLE)args[0]->Uint32Value();
+  DWORD64 pointerArray = args[1]->IntegerValue();
+  size_t count = args[2]->Uint32Value();
+
+  // layout is { name: { offset, type }, ... }
+  Local<Object> layout = args[3]->ToObject();
+  Local<Array> names = layout->GetOwnPropertyNames();
+
+  std::vector<gather::Field> fields;
+  std::vector<ArrayType> types;
+
+  for (unsigned int i = 0; i < names->Length(); i++) {
+    Local<Value> field = layout->Get(names->Get(i));
+
+    if (!field->IsObject()) {
+      memoryjs::throwError("layout fields must be objects of the form { offset, type }", isolate);
+      return;
+    }
+
+    // the result has valid and pointers columns of its own, a field of the same name would overwrite them
+    v8::String::Utf8Value name(names->Get(i));
+
+    if (!strcmp(*name, "valid") || !strcmp(*name, "pointers")) {
+      memoryjs::throwError("layout fields can't be named valid or pointers", isolate);
+      return;
+    }
+
+    Local<Object> fieldInfo = field->ToObject();
+    v8::String::Utf8Value dataTypeArg(fieldInfo->Get(String::NewFromUtf8(isolate, "type")));
+    ArrayType arrayType = getArrayType((char*) *(dataTypeArg));
+
+    if (arrayType == ARRAY_INVALID) {
+      memoryjs::throwError("unexpected data type", isolate);
+      return;
+    }
+
+    gather::Field gatherField = {
+      fieldInfo->Get(String::NewFromUtf8(isolate, "offset"))->Uint32Value(),
+      getArrayTypeSize(arrayType)
+    };
+
+    fields.push_back(gatherField);
+    types.push_back(arrayType);
+  }
+
+  // One column per field, pointer columns are gathered into a temporary buffer and widened afterwards
+  std::vector<Local<v8::TypedArray>> columns;
+  std::vector<std::vector<intptr_t>> pointerColumns(fields.size());
+  std::vector<unsigned char*> outputs;
+
+  for (std::vector<gather::Field>::size_type f = 0; f != fields.size(); f++) {
+    columns.push_back(createTypedArray(isolate, types[f], count));
+
+    if (types[f] == ARRAY_PTR) {
+      pointerColumns[f].resize(count + 1);
+      outputs.push_back((unsigned char*)&pointerColumns[f][0]);
+    } else {
+      outputs.push_back(static_cast<unsigned char*>(memoryjs::getViewData(columns[f])));
+    }
+  }
+
+  Local<v8::TypedArray> valid = createTypedArray(isolate, ARRAY_BOOL, count);
+  std::vector<uintptr_t> pointers;
+
+  char* errorMessage = "";
+  addon->Gather.gatherFromPointers(handle, pointerArray, count, fields, pointers, outputs, static_cast<unsigned char*>(memoryjs::getViewData(valid)), addon->Pool, &errorMessage);
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  Local<Object> result = Object::New(isolate);
+
+  Local<v8::TypedArray> pointerColumn = createTypedArray(isolate, ARRAY_PTR, count);
+  double* pointerValues = static_cast<double*>(memoryjs::getViewData(pointerColumn));
+  for (size_t i = 0; i < count; i++) pointerValues[i] = (double)pointers[i];
+
+  result->Set(String::NewFromUtf8(isolate, "valid"), valid);
+  result->Set(String::NewFromUtf8(isolate, "pointers"), pointerColumn);
+
+  for (std::vector<gather::Field>::size_type f = 0; f != fields.size(); f++) {
+    if (types[f] == ARRAY_PTR) {
+      double* values = static_cast<double*>(memoryjs::getViewData(columns[f]));
+      for (size_t i = 0; i < count; i++) values[i] = (double)pointerColumns[f][i];
+    }
+
+    result->Set(names->Get(f), columns[f]);
+  }
+
+  args.GetReturnValue().Set(result);
+}
+
+void setReaderOptions(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 1 || !args[0]->IsObject()) {
+    memoryjs::throwError("requires 1 argument, an object", isolate);
+    return;
+  }
+
+  Local<Object> options = args[0]->ToObject();
+  SIZE_T queueDepth = (SIZE_T)getOption(isolate, options, "queueDepth", (double)addon->Reader.getQueueDepth());
+  SIZE_T chunkSize = (SIZE_T)getOption(isolate, options, "chunkSize", (double)addon->Reader.getChunkSize());
+
+  addon->Reader.configure(queueDepth, chunkSize);
+}
+
+void setBufferPoolOptions(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 1 || !args[0]->IsObject()) {
+    memoryjs::throwError("requires 1 argument, an object", isolate);
+    return;
   }
+
+  Local<Object> options = args[0]->ToObject();
+  Local<Value> limit = options->Get(String::NewFromUtf8(isolate, "limit"));
+  Local<Value> largePages = options->Get(String::NewFromUtf8(isolate, "largePages"));
+
+  if (limit->IsNumber()) addon->Pool.setLimit((SIZE_T)limit->NumberValue());
+  if (largePages->IsBoolean()) addon->Pool.setLargePages(largePages->BooleanValue());
+}
+
+void getBufferPoolStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  bufferpool::Stats stats = addon->Pool.getStats();
+  Local<Object> result = Object::New(isolate);
+
+  result->Set(String::NewFromUtf8(isolate, "bytesReserved"), Number::New(isolate, (double)stats.bytesReserved));
+  result->Set(String::NewFromUtf8(isolate, "bytesInUse"), Number::New(isolate, (double)stats.bytesInUse));
+  result->Set(String::NewFromUtf8(isolate, "limit"), Number::New(isolate, (double)stats.limit));
+  result->Set(String::NewFromUtf8(isolate, "buffers"), Number::New(isolate, (double)stats.buffers));
+  result->Set(String::NewFromUtf8(isolate, "largePageBuffers"), Number::New(isolate, (double)stats.largePageBuffers));
+  result->Set(String::NewFromUtf8(isolate, "hits"), Number::New(isolate, (double)stats.hits));
+  result->Set(String::NewFromUtf8(isolate, "misses"), Number::New(isolate, (double)stats.misses));
+
+  args.GetReturnValue().Set(result);
 }
 
-void init(Local<Object> exports) {
-  NODE_SET_METHOD(exports, "openProcess", openProcess);
-  NODE_SET_METHOD(exports, "closeProcess", closeProcess);
-  NODE_SET_METHOD(exports, "getProcesses", getProcesses);
-  NODE_SET_METHOD(exports, "getModules", getModules);
-  NODE_SET_METHOD(exports, "findModule", findModule);
-  NODE_SET_METHOD(exports, "readMemory", readMemory);
-  NODE_SET_METHOD(exports, "writeMemory", writeMemory);
-  NODE_SET_METHOD(exports, "findPattern", findPattern);
+// Reads an optional priority name from an options object
+bool getPriorityOption(Isolate* isolate, Local<Object> options, const char* name, scheduler::Priority* priority) {
+  Local<Value> value = options->Get(String::NewFromUtf8(isolate, name));
+  if (value->IsUndefined()) return true;
+
+  v8::String::Utf8Value priorityName(value);
+
+  if (!value->IsString() || !scheduler::parsePriority(*priorityName, priority)) {
+    memoryjs::throwError("priority must be 'critical', 'normal' or 'background'", isolate);
+    return false;
+  }
+
+  return true;
 }
 
-NODE_MODULE(memoryjs, init)
+void setSchedulerOptions(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 1 || !args[0]->IsObject()) {
+    memoryjs::throwError("requires 1 argument, an object", isolate);
+    return;
+  }
+
+  Local<Object> options = args[0]->ToObject();
+  Local<Value> threads = options->Get(String::NewFromUtf8(isolate, "threads"));
+
+  // the priorities belong to this thread's instance, the worker pool is shared by every thread
+  scheduler::Priority readPriority = addon->Reader.getReadPriority();
+  scheduler::Priority scanPriority = addon->Reader.getScanPriority();
+
+  if (!getPriorityOption(isolate, options, "readPriority", &readPriority)) return;
+  if (!getPriorityOption(isolate, options, "scanPriority", &scanPriority)) return;
+
+  addon->Reader.setPriorities(readPriority, scanPriority);
+  if (threads->IsNumber()) scheduler::get().setThreadCount((SIZE_T)threads->NumberValue());
+}
+
+void getSchedulerStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+
+  scheduler& Scheduler = scheduler::get();
+  Local<Object> result = Object::New(isolate);
+
+  result->Set(String::NewFromUtf8(isolate, "threads"), Number::New(isolate, (double)Scheduler.getThreadCount()));
+  result->Set(String::NewFromUtf8(isolate, "handles"), Number::New(isolate, (double)Scheduler.getHandleCount()));
+
+  for (int i = 0; i < scheduler::PRIORITY_COUNT; i++) {
+    scheduler::Stats stats = Scheduler.getStats((scheduler::Priority)i);
+    Local<Object> priority = Object::New(isolate);
+
+    priority->Set(String::NewFromUtf8(isolate, "queued"), Number::New(isolate, (double)stats.queued));
+    priority->Set(String::NewFromUtf8(isolate, "peakQueued"), Number::New(isolate, (double)stats.peakQueued));
+    priority->Set(String::NewFromUtf8(isolate, "running"), Number::New(isolate, (double)stats.running));
+    priority->Set(String::NewFromUtf8(isolate, "completed"), Number::New(isolate, (double)stats.completed));
+    priority->Set(String::NewFromUtf8(isolate, "waitAverage"), Number::New(isolate, stats.waitAverage));
+    priority->Set(String::NewFromUtf8(isolate, "waitP99"), Number::New(isolate, stats.waitP99));
+
+    result->Set(String::NewFromUtf8(isolate, scheduler::getPriorityName((scheduler::Priority)i)), priority);
+  }
+
+  args.GetReturnValue().Set(result);
+}
+
+// Converts pointer chains to an array of { module, baseOffset, offsets }
+Local<Array> chainsToArray(Isolate* isolate, const std::vector<pointerscan::Chain>& chains) {
+  Local<Array> result = Array::New(isolate, chains.size());
+
+  for (std::vector<pointerscan::Chain>::size_type i = 0; i != chains.size(); i++) {
+    Local<Object> chain = Object::New(isolate);
+    Local<Array> offsets = Array::New(isolate, chains[i].offsets.size());
+
+    for (std::vector<uintptr_t>::size_type j = 0; j != chains[i].offsets.size(); j++) {
+      offsets->Set(j, Number::New(isolate, (double)chains[i].offsets[j]));
+    }
+
+    chain->Set(String::NewFromUtf8(isolate, "module"), String::NewFromUtf8(isolate, chains[i].module.c_str()));
+    chain->Set(String::NewFromUtf8(isolate, "baseOffset"), Number::New(isolate, (double)chains[i].baseOffset));
+    chain->Set(String::NewFromUtf8(isolate, "offsets"), offsets);
+
+    result->Set(i, chain);
+  }
+
+  return result;
+}
+
+void pointerScan(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 2 && args.Length() != 3) {
+    memoryjs::throwError("requires 2 arguments, or 3 arguments if options are being used", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsNumber()) {
+    memoryjs::throwError("first and second argument must be a number", isolate);
+    return;
+  }
+
+  Local<Object> options = args.Length() == 3 && args[2]->IsObject() ? args[2]->ToObject() : Object::New(isolate);
+
+  scancontrol control;
+  if (!setScanControl(isolate, options, control)) return;
+
+  HANDLE handle = (HANDLE)args[0]->Uint32Value();
+  uintptr_t target = (uintptr_t)args[1]->IntegerValue();
+  int maxDepth = (int)getOption(isolate, options, "maxDepth", 5);
+  uintptr_t maxOffset = (uintptr_t)getOption(isolate, options, "maxOffset", 0x1000);
+  SIZE_T maxResults = (SIZE_T)getOption(isolate, options, "maxResults", 10000);
+  SIZE_T maxMemory = (SIZE_T)getOption(isolate, options, "maxMemory", 256 * 1024 * 1024);
+  SIZE_T maxNodes = (SIZE_T)getOption(isolate, options, "maxNodes", pointerscan::DEFAULT_MAX_NODES);
+
+  char* errorMessage = "";
+
+  std::vector<MODULEENTRY32> modules = addon->Module.getModules(GetProcessId(handle), &errorMessage);
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  // The index is either loaded from a previous scan or built from the process' memory
+  std::vector<pointerscan::Entry> index;
+  Local<Value> loadPath = options->Get(String::NewFromUtf8(isolate, "loadIndex"));
+  Local<Value> savePath = options->Get(String::NewFromUtf8(isolate, "saveIndex"));
+
+  if (loadPath->IsString()) {
+    v8::String::Utf8Value path(loadPath);
+    addon->PointerScan.loadIndex(*path, maxMemory / sizeof(pointerscan::Entry), index, &errorMessage);
+
+    // nothing is read from the process, the timeout only covers the search
+    control.begin(0);
+  } else {
+    addon->PointerScan.buildIndex(handle, maxMemory / sizeof(pointerscan::Entry), index, addon->Pool, addon->Reader.getScanPriority(), &control, &errorMessage);
+  }
+
+  // A partial index would give partial results on every later load, so it is never saved
+  if (!strcmp(errorMessage, "") && savePath->IsString() && !control.wasStopped()) {
+    v8::String::Utf8Value path(savePath);
+    addon->PointerScan.saveIndex(*path, index, &errorMessage);
+  }
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  // An index that was cut short is still searched, for the chains through the memory read before that.
+  // The control has already stopped by then, so only maxNodes bounds that search.
+  bool indexComplete = !control.wasStopped();
+  bool complete = false;
+  std::vector<pointerscan::Chain> chains = addon->PointerScan.scan(index, modules, target, maxDepth, maxOffset, maxResults, maxNodes,
+    indexComplete ? &control : nullptr, &complete);
+  Local<Array> result = chainsToArray(isolate, chains);
+
+  // false if the index build or the search was cancelled, timed out or hit maxNodes
+  result->Set(String::NewFromUtf8(isolate, "complete"), Boolean::New(isolate, complete && indexComplete && !control.wasStopped()));
+  args.GetReturnValue().Set(result);
+}
+
+void rescanPointers(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 3) {
+    memoryjs::throwError("requires 3 arguments", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsArray() || !args[2]->IsNumber()) {
+    memoryjs::throwError("first argument must be a number, second argument must be an array, third argument must be a number", isolate);
+    return;
+  }
+
+  HANDLE handle = (HANDLE)args[0]->Uint32Value();
+  Local<Array> chainArray = Local<Array>::Cast(args[1]);
+  uintptr_t target = (uintptr_t)args[2]->IntegerValue();
+
+  std::vector<pointerscan::Chain> chains;
+
+  for (unsigned int i = 0; i < chainArray->Length(); i++) {
+    Local<Object> chainInfo = chainArray->Get(i)->ToObject();
+    Local<Value> offsetsValue = chainInfo->Get(String::NewFromUtf8(isolate, "offsets"));
+
+    if (!offsetsValue->IsArray()) {
+      memoryjs::throwError("chains must be objects of the form { module, baseOffset, offsets }", isolate);
+      return;
+    }
+
+    Local<Array> offsets = Local<Array>::Cast(offsetsValue);
+    v8::String::Utf8Value moduleName(chainInfo->Get(String::NewFromUtf8(isolate, "module")));
+
+    pointerscan::Chain chain;
+    chain.module = *moduleName;
+    chain.baseOffset = (uintptr_t)chainInfo->Get(String::NewFromUtf8(isolate, "baseOffset"))->IntegerValue();
+
+    for (unsigned int j = 0; j < offsets->Length(); j++) {
+      chain.offsets.push_back((uintptr_t)offsets->Get(j)->IntegerValue());
+    }
+
+    chains.push_back(chain);
+  }
+
+  char* errorMessage = "";
+
+  std::vector<MODULEENTRY32> modules = addon->Module.getModules(GetProcessId(handle), &errorMessage);
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  args.GetReturnValue().Set(chainsToArray(isolate, addon->PointerScan.rescan(handle, chains, modules, target)));
+}
+
+// Converts strings found by findStrings to columns: address, characters, encoding and text (if requested),
+// the last two are indices into a string table like the columns of getProcessTable
+Local<Object> stringsToColumns(Isolate* isolate, instance* addon, const std::vector<stringscan::Result>& results, bool includeText) {
+  size_t count = results.size();
+  Local<v8::TypedArray> address = createTypedArray(isolate, ARRAY_DOUBLE, count);
+  Local<v8::TypedArray> characters = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> encoding = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> text = createTypedArray(isolate, ARRAY_DWORD, includeText ? count : 0);
+
+  double* addressData = static_cast<double*>(memoryjs::getViewData(address));
+  uint32_t* charactersData = static_cast<uint32_t*>(memoryjs::getViewData(characters));
+  uint32_t* encodingData = static_cast<uint32_t*>(memoryjs::getViewData(encoding));
+  uint32_t* textData = static_cast<uint32_t*>(memoryjs::getViewData(text));
+
+  stringtable strings(isolate);
+
+  for (size_t i = 0; i < count; i++) {
+    addressData[i] = (double)results[i].address;
+    charactersData[i] = (uint32_t)results[i].length;
+    encodingData[i] = strings.intern(stringscan::getEncodingName(results[i].encoding));
+    if (includeText) textData[i] = strings.intern(results[i].text.c_str());
+  }
+
+  Local<Object> table = Object::New(isolate);
+  table->Set(addon->key(instance::KEY_LENGTH), Number::New(isolate, (double)count));
+  table->Set(String::NewFromUtf8(isolate, "address"), address);
+  table->Set(String::NewFromUtf8(isolate, "characters"), characters);
+  table->Set(String::NewFromUtf8(isolate, "encoding"), encoding);
+  if (includeText) table->Set(String::NewFromUtf8(isolate, "text"), text);
+  table->Set(addon->key(instance::KEY_STRINGS), strings.strings);
+
+  return table;
+}
+
+void findStrings(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 1 && args.Length() != 2) {
+    memoryjs::throwError("requires 1 argument, or 2 arguments if options are being used", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || (args.Length() == 2 && !args[1]->IsObject())) {
+    memoryjs::throwError("first argument must be a number, second argument must be an object", isolate);
+    return;
+  }
+
+  HANDLE handle = (HANDLE)args[0]->Uint32Value();
+  Local<Object> options = args.Length() == 2 ? args[1]->ToObject() : Object::New(isolate);
+
+  scancontrol control;
+  if (!setScanControl(isolate, options, control)) return;
+
+  // checked before the conversion, a NaN or huge maxLength has no SIZE_T value
+  double maxLength = getOption(isolate, options, "maxLength", 1024);
+
+  if (!(maxLength >= 1 && maxLength <= stringscan::MAX_LENGTH)) {
+    memoryjs::throwError("maxLength must be at least 1 and at most 65536", isolate);
+    return;
+  }
+
+  stringscan::Options scanOptions;
+  scanOptions.minLength = (SIZE_T)getOption(isolate, options, "minLength", 4);
+  scanOptions.maxLength = (SIZE_T)maxLength;
+  scanOptions.maxResults = (SIZE_T)getOption(isolate, options, "maxResults", 1000000);
+  scanOptions.prefix = options->Get(String::NewFromUtf8(isolate, "prefix"))->BooleanValue();
+  scanOptions.text = !options->Get(String::NewFromUtf8(isolate, "text"))->IsFalse();
+
+  if (scanOptions.minLength < 1 || scanOptions.maxLength < scanOptions.minLength) {
+    memoryjs::throwError("minLength must be at least 1 and no more than maxLength", isolate);
+    return;
+  }
+
+  Local<Value> filter = options->Get(String::NewFromUtf8(isolate, "filter"));
+  if (filter->IsString()) {
+    v8::String::Utf8Value filterString(filter);
+    scanOptions.filter = *filterString;
+  }
+
+  // both encodings unless some are given
+  Local<Value> encodings = options->Get(String::NewFromUtf8(isolate, "encodings"));
+
+  for (int i = 0; i < stringscan::ENCODING_COUNT; i++) scanOptions.encodings[i] = !encodings->IsArray();
+
+  if (encodings->IsArray()) {
+    Local<Array> encodingArray = Local<Array>::Cast(encodings);
+
+    for (unsigned int i = 0; i < encodingArray->Length(); i++) {
+      v8::String::Utf8Value name(encodingArray->Get(i));
+      stringscan::Encoding encoding;
+
+      if (!stringscan::parseEncoding(*name, &encoding)) {
+        memoryjs::throwError("encodings must be 'ascii' or 'utf16le'", isolate);
+        return;
+      }
+
+      scanOptions.encodings[encoding] = true;
+    }
+  }
+
+  // regions: all readable memory, only writable memory, a module, or a list of { address, size }
+  Local<Value> regions = options->Get(String::NewFromUtf8(isolate, "regions"));
+  std::vector<reader::Range> ranges;
+  char* errorMessage = "";
+
+  if (regions->IsArray()) {
+    Local<Array> regionArray = Local<Array>::Cast(regions);
+
+    for (unsigned int i = 0; i < regionArray->Length(); i++) {
+      Local<Object> region = regionArray->Get(i)->ToObject();
+      reader::Range range = {
+        (uintptr_t)region->Get(String::NewFromUtf8(isolate, "address"))->IntegerValue(),
+        (SIZE_T)region->Get(String::NewFromUtf8(isolate, "size"))->IntegerValue()
+      };
+      ranges.push_back(range);
+    }
+  } else {
+    v8::String::Utf8Value regionName(regions);
+    std::string name = regions->IsString() ? *regionName : "all";
+
+    if (name == "all" || name == "writable") {
+      std::vector<memory::Region> memoryRegions = memory::getRegions(handle, name == "writable");
+
+      for (std::vector<memory::Region>::size_type i = 0; i != memoryRegions.size(); i++) {
+        reader::Range range = { memoryRegions[i].base, memoryRegions[i].size };
+        ranges.push_back(range);
+      }
+    } else {
+      std::vector<MODULEENTRY32> moduleEntries = addon->Module.getModules(GetProcessId(handle), &errorMessage);
+
+      for (std::vector<MODULEENTRY32>::size_type i = 0; i != moduleEntries.size(); i++) {
+        if (name == moduleEntries[i].szModule) {
+          reader::Range range = { (uintptr_t)moduleEntries[i].modBaseAddr, moduleEntries[i].modBaseSize };
+          ranges.push_back(range);
+          break;
+        }
+      }
+
+      if (!strcmp(errorMessage, "") && ranges.empty()) errorMessage = "unable to find module";
+    }
+  }
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  Local<Value> onStrings = options->Get(String::NewFromUtf8(isolate, "onStrings"));
+  std::vector<stringscan::Result> results;
+  SIZE_T count = 0;
+  bool complete;
+
+  if (onStrings->IsFunction()) {
+    // streamed: every batch of strings is passed to onStrings as soon as it is found
+    Local<Function> callback = Local<Function>::Cast(onStrings);
+
+    complete = addon->StringScan.findStrings(handle, ranges, scanOptions, addon->Reader, &control, [&](std::vector<stringscan::Result>& batch) {
+      const unsigned argc = 1;
+      Local<Value> argv[argc] = { stringsToColumns(isolate, addon, batch, scanOptions.text) };
+      callback->Call(Null(isolate), argc, argv);
+      count += batch.size();
+      return true;
+    }, &errorMessage);
+
+    if (strcmp(errorMessage, "")) {
+      memoryjs::throwError(errorMessage, isolate);
+      return;
+    }
+
+    Local<Object> result = Object::New(isolate);
+    result->Set(String::NewFromUtf8(isolate, "count"), Number::New(isolate, (double)count));
+    result->Set(String::NewFromUtf8(isolate, "complete"), Boolean::New(isolate, complete));
+    args.GetReturnValue().Set(result);
+    return;
+  }
+
+  complete = addon->StringScan.findStrings(handle, ranges, scanOptions, addon->Reader, &control, [&](std::vector<stringscan::Result>& batch) {
+    results.insert(results.end(), batch.begin(), batch.end());
+    return true;
+  }, &errorMessage);
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  // chunks complete out of order
+  std::sort(results.begin(), results.end(), [](const stringscan::Result& a, const stringscan::Result& b) {
+    return a.address < b.address || (a.address == b.address && a.encoding < b.encoding);
+  });
+
+  Local<Object> table = stringsToColumns(isolate, addon, results, scanOptions.text);
+  table->Set(String::NewFromUtf8(isolate, "complete"), Boolean::New(isolate, complete));
+  args.GetReturnValue().Set(table);
+}
+
+void getExports(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 2) {
+    memoryjs::throwError("requires 2 arguments", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsString()) {
+    memoryjs::throwError("first argument must be a number, second argument must be a string", isolate);
+    return;
+  }
+
+  HANDLE handle = (HANDLE)args[0]->Uint32Value();
+  v8::String::Utf8Value moduleName(args[1]);
+  char* errorMessage = "";
+
+  image::Info* info = addon->Image.getExports(handle, *moduleName, addon->Module, &errorMessage);
+
+  if (info == nullptr) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  // columns: name and forwarder are indices into the string table, address is 0 for forwarded exports
+  size_t count = info->exports.size();
+  Local<v8::TypedArray> name = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> ordinal = createTypedArray(isolate, ARRAY_DWORD, count);
+  Local<v8::TypedArray> address = createTypedArray(isolate, ARRAY_DOUBLE, count);
+  Local<v8::TypedArray> forwarder = createTypedArray(isolate, ARRAY_DWORD, count);
+
+  uint32_t* nameData = static_cast<uint32_t*>(memoryjs::getViewData(name));
+  uint32_t* ordinalData = static_cast<uint32_t*>(memoryjs::getViewData(ordinal));
+  double* addressData = static_cast<double*>(memoryjs::getViewData(address));
+  uint32_t* forwarderData = static_cast<uint32_t*>(memoryjs::getViewData(forwarder));
+
+  stringtable strings(isolate);
+
+  for (size_t i = 0; i < count; i++) {
+    const image::Export& entry = info->exports[i];
+    nameData[i] = strings.intern(entry.name.c_str());
+    ordinalData[i] = (uint32_t)entry.ordinal;
+    addressData[i] = (double)entry.address;
+    forwarderData[i] = strings.intern(entry.forwarder.c_str());
+  }
+
+  Local<Object> table = Object::New(isolate);
+  table->Set(addon->key(instance::KEY_LENGTH), Number::New(isolate, (double)count));
+  table->Set(String::NewFromUtf8(isolate, "name"), name);
+  table->Set(String::NewFromUtf8(isolate, "ordinal"), ordinal);
+  table->Set(String::NewFromUtf8(isolate, "address"), address);
+  table->Set(String::NewFromUtf8(isolate, "forwarder"), forwarder);
+  table->Set(addon->key(instance::KEY_STRINGS), strings.strings);
+
+  args.GetReturnValue().Set(table);
+}
+
+void findExport(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 3) {
+    memoryjs::throwError("requires 3 arguments", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsString() || (!args[2]->IsString() && !args[2]->IsNumber())) {
+    memoryjs::throwError("first argument must be a number, second argument must be a string, third argument must be a string or a number", isolate);
+    return;
+  }
+
+  HANDLE handle = (HANDLE)args[0]->Uint32Value();
+  v8::String::Utf8Value moduleName(args[1]);
+  v8::String::Utf8Value exportName(args[2]);
+  char* errorMessage = "";
+
+  // a number is an ordinal
+  const char* name = args[2]->IsString() ? *exportName : nullptr;
+  uintptr_t address = addon->Image.findExport(handle, *moduleName, name, args[2]->Uint32Value(), addon->Module, &errorMessage);
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  args.GetReturnValue().Set(Number::New(isolate, (double)address));
+}
+
+void record(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 3) {
+    memoryjs::throwError("requires 3 arguments", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsObject() || !args[2]->IsObject()) {
+    memoryjs::throwError("first argument must be a number, second and third arguments must be objects", isolate);
+    return;
+  }
+
+  HANDLE handle = (HANDLE)args[0]->Uint32Value();
+
+  // fields are { name: { address, type } }
+  Local<Object> layout = args[1]->ToObject();
+  Local<Array> names = layout->GetOwnPropertyNames();
+  std::vector<recorder::Field> fields;
+
+  for (unsigned int i = 0; i < names->Length(); i++) {
+    Local<Value> field = layout->Get(names->Get(i));
+
+    if (!field->IsObject()) {
+      memoryjs::throwError("fields must be objects of the form { address, type }", isolate);
+      return;
+    }
+
+    Local<Object> fieldInfo = field->ToObject();
+    v8::String::Utf8Value name(names->Get(i));
+    v8::String::Utf8Value dataType(fieldInfo->Get(String::NewFromUtf8(isolate, "type")));
+    recorder::Field recorderField;
+
+    if (!recorder::parseType(*dataType, &recorderField.type)) {
+      memoryjs::throwError("unexpected data type", isolate);
+      return;
+    }
+
+    Local<Value> address = fieldInfo->Get(String::NewFromUtf8(isolate, "address"));
+
+    if (!address->IsNumber()) {
+      memoryjs::throwError("fields must be objects of the form { address, type }", isolate);
+      return;
+    }
+
+    recorderField.name = *name;
+    recorderField.address = (uintptr_t)address->IntegerValue();
+    fields.push_back(recorderField);
+  }
+
+  Local<Object> options = args[2]->ToObject();
+  Local<Value> path = options->Get(String::NewFromUtf8(isolate, "path"));
+
+  if (!path->IsString()) {
+    memoryjs::throwError("path must be a string", isolate);
+    return;
+  }
+
+  v8::String::Utf8Value pathString(path);
+  recorder::Options recorderOptions;
+  recorderOptions.rateHz = getOption(isolate, options, "rateHz", 60);
+  recorderOptions.path = *pathString;
+  recorderOptions.chunkSamples = getOption(isolate, options, "chunkSamples", 1024);
+  recorderOptions.chunkInterval = getOption(isolate, options, "chunkInterval", 5000);
+
+  char* errorMessage = "";
+  int id = addon->Recorder.start(handle, fields, recorderOptions, &errorMessage);
+
+  if (strcmp(errorMessage, "")) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  args.GetReturnValue().Set(Number::New(isolate, id));
+}
+
+Local<Object> recordingStatsToObject(Isolate* isolate, const recorder::Stats& stats) {
+  Local<Object> result = Object::New(isolate);
+
+  result->Set(String::NewFromUtf8(isolate, "running"), Boolean::New(isolate, stats.running));
+  result->Set(String::NewFromUtf8(isolate, "samples"), Number::New(isolate, (double)stats.samples));
+  result->Set(String::NewFromUtf8(isolate, "chunks"), Number::New(isolate, (double)stats.chunks));
+  result->Set(String::NewFromUtf8(isolate, "bytesWritten"), Number::New(isolate, (double)stats.bytesWritten));
+  result->Set(String::NewFromUtf8(isolate, "missedSamples"), Number::New(isolate, (double)stats.missedSamples));
+  result->Set(String::NewFromUtf8(isolate, "failedReads"), Number::New(isolate, (double)stats.failedReads));
+  result->Set(String::NewFromUtf8(isolate, "error"), String::NewFromUtf8(isolate, stats.error));
+
+  return result;
+}
+
+void getRecordingStats(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 1 || !args[0]->IsNumber()) {
+    memoryjs::throwError("requires 1 argument, a number", isolate);
+    return;
+  }
+
+  recorder::Stats stats;
+
+  if (!addon->Recorder.getStats(args[0]->Int32Value(), &stats)) {
+    memoryjs::throwError("unable to find recording", isolate);
+    return;
+  }
+
+  args.GetReturnValue().Set(recordingStatsToObject(isolate, stats));
+}
+
+void stopRecording(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  instance* addon = instance::get(args);
+
+  if (args.Length() != 1 || !args[0]->IsNumber()) {
+    memoryjs::throwError("requires 1 argument, a number", isolate);
+    return;
+  }
+
+  recorder::Stats stats;
+
+  if (!addon->Recorder.stop(args[0]->Int32Value(), &stats)) {
+    memoryjs::throwError("unable to find recording", isolate);
+    return;
+  }
+
+  args.GetReturnValue().Set(recordingStatsToObject(isolate, stats));
+}
+
+void readRecording(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+
+  if (args.Length() != 1 && args.Length() != 2) {
+    memoryjs::throwError("requires 1 argument, or 2 arguments if options are being used", isolate);
+    return;
+  }
+
+  if (!args[0]->IsString() || (args.Length() == 2 && !args[1]->IsObject())) {
+    memoryjs::throwError("first argument must be a string, second argument must be an object", isolate);
+    return;
+  }
+
+  v8::String::Utf8Value path(args[0]);
+  Local<Object> options = args.Length() == 2 ? args[1]->ToObject() : Object::New(isolate);
+
+  // from and to are milliseconds since the Unix epoch (Date.now()), by default the whole recording
+  double from = getOption(isolate, options, "from", -std::numeric_limits<double>::infinity());
+  double to = getOption(isolate, options, "to", std::numeric_limits<double>::infinity());
+
+  char* errorMessage = "";
+  recorder::Recording recording;
+
+  if (!recorder::read(*path, from, to, recording, &errorMessage)) {
+    memoryjs::throwError(errorMessage, isolate);
+    return;
+  }
+
+  size_t count = recording.times.size();
+  Local<v8::TypedArray> time = createTypedArray(isolate, ARRAY_DOUBLE, count);
+  if (count > 0) memcpy(memoryjs::getViewData(time), &recording.times[0], count * sizeof(double));
+
+  // one Float64Array per field, NaN where the field couldn't be read
+  Local<Object> values = Object::New(isolate);
+  Local<Object> types = Object::New(isolate);
+
+  for (std::vector<recorder::Field>::size_type i = 0; i != recording.fields.size(); i++) {
+    Local<v8::TypedArray> column = createTypedArray(isolate, ARRAY_DOUBLE, count);
+    if (count > 0) memcpy(memoryjs::getViewData(column), &recording.values[i][0], count * sizeof(double));
+
+    Local<String> name = String::NewFromUtf8(isolate, recording.fields[i].name.c_str());
+    values->Set(name, column);
+    types->Set(name, String::NewFromUtf8(isolate, recorder::getTypeName(recording.fields[i].type)));
+  }
+
+  Local<Object> result = Object::New(isolate);
+  result->Set(String::NewFromUtf8(isolate, "length"), Number::New(isolate, (double)count));
+  result->Set(String::NewFromUtf8(isolate, "rateHz"), Number::New(isolate, recording.rateHz));
+  result->Set(String::NewFromUtf8(isolate, "time"), time);
+  result->Set(String::NewFromUtf8(isolate, "values"), values);
+  result->Set(String::NewFromUtf8(isolate, "types"), types);
+
+  args.GetReturnValue().Set(result);
+}
+
+// Typed accessors: these skip the data type string dispatch of readMemory/writeMemory.
+// dataType is the type in memory, jsType is the type handed to/from JavaScript.
+template <class dataType, class jsType>
+void readTyped(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+
+  if (args.Length() != 2) {
+    memoryjs::throwError("requires 2 arguments", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsNumber()) {
+    memoryjs::throwError("first and second argument must be a number", isolate);
+    return;
+  }
+
+  dataType result = memory::readMemory<dataType>((HANDLE)args[0]->Uint32Value(), args[1]->IntegerValue());
+  args.GetReturnValue().Set((jsType)result);
+}
+
+template <class dataType, class jsType>
+void writeTyped(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+
+  if (args.Length() != 3) {
+    memoryjs::throwError("requires 3 arguments", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsNumber()) {
+    memoryjs::throwError("first and second argument must be a number", isolate);
+    return;
+  }
+
+  memory::writeMemory<dataType>((HANDLE)args[0]->Uint32Value(), args[1]->IntegerValue(), (dataType)args[2]->NumberValue());
+}
+
+// bool values are converted with BooleanValue rather than NumberValue
+template <>
+void writeTyped<bool, bool>(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+
+  if (args.Length() != 3) {
+    memoryjs::throwError("requires 3 arguments", isolate);
+    return;
+  }
+
+  if (!args[0]->IsNumber() || !args[1]->IsNumber()) {
+    memoryjs::throwError("first and second argument must be a number", isolate);
+    return;
+  }
+
+  memory::writeMemory<bool>((HANDLE)args[0]->Uint32Value(), args[1]->IntegerValue(), args[2]->BooleanValue());
+}
+
+// Registers a method with the addon instance as its data
+void setMethod(Local<Object> exports, const char* name, v8::FunctionCallback callback, Local<Value> data) {
+  Isolate* isolate = exports->GetIsolate();
+  Local<v8::Context> context = isolate->GetCurrentContext();
+
+  Local<v8::FunctionTemplate> tpl = v8::FunctionTemplate::New(isolate, callback, data);
+
+  Local<String> methodName = String::NewFromUtf8(isolate, name, v8::NewStringType::kInternalized).ToLocalChecked();
+  Local<Function> method = tpl->GetFunction(context).ToLocalChecked();
+  method->SetName(methodName);
+  exports->Set(context, methodName, method).FromJust();
+}
+
+// The addon is context-aware so it can be loaded by worker threads, every
+// environment that loads it gets its own instance (freed by a cleanup hook)
+NODE_MODULE_INIT() {
+  Isolate* isolate = context->GetIsolate();
+  Local<Value> data = v8::External::New(isolate, new instance(isolate));
+
+  setMethod(exports, "openProcess", openProcess, data);
+  setMethod(exports, "closeProcess", closeProcess, data);
+  setMethod(exports, "getProcesses", getProcesses, data);
+  setMethod(exports, "getModules", getModules, data);
+  setMethod(exports, "getProcessTable", getProcessTable, data);
+  setMethod(exports, "getModuleTable", getModuleTable, data);
+  setMethod(exports, "findModule", findModule, data);
+  setMethod(exports, "readMemory", readMemory, data);
+  setMethod(exports, "writeMemory", writeMemory, data);
+  setMethod(exports, "findPattern", findPattern, data);
+  setMethod(exports, "readArray", readArray, data);
+  setMethod(exports, "readStrided", readStrided, data);
+  setMethod(exports, "gatherFromPointers", gatherFromPointers, data);
+  setMethod(exports, "pointerScan", pointerScan, data);
+  setMethod(exports, "rescanPointers", rescanPointers, data);
+  setMethod(exports, "findStrings", findStrings, data);
+  setMethod(exports, "getExports", getExports, data);
+  setMethod(exports, "findExport", findExport, data);
+  setMethod(exports, "record", record, data);
+  setMethod(exports, "getRecordingStats", getRecordingStats, data);
+  setMethod(exports, "stopRecording", stopRecording, data);
+  setMethod(exports, "readRecording", readRecording, data);
+  setMethod(exports, "setReaderOptions", setReaderOptions, data);
+  setMethod(exports, "setBufferPoolOptions", setBufferPoolOptions, data);
+  setMethod(exports, "getBufferPoolStats", getBufferPoolStats, data);
+  setMethod(exports, "setSchedulerOptions", setSchedulerOptions, data);
+  setMethod(exports, "getSchedulerStats", getSchedulerStats, data);
+
+  setMethod(exports, "readInt32", readTyped<int, int32_t>, data);
+  setMethod(exports, "readUInt32", readTyped<DWORD, uint32_t>, data);
+  setMethod(exports, "readFloat", readTyped<float, double>, data);
+  setMethod(exports, "readDouble", readTyped<double, double>, data);
+  setMethod(exports, "readPtr", readTyped<intptr_t, double>, data);
+  setMethod(exports, "readBool", readTyped<bool, bool>, data);
+  setMethod(exports, "writeInt32", writeTyped<int, int32_t>, data);
+  setMethod(exports, "writeUInt32", writeTyped<DWORD, uint32_t>, data);
+  setMethod(exports, "writeFloat", writeTyped<float, double>, data);
+  setMethod(exports, "writeDouble", writeTyped<double, double>, data);
+  setMethod(exports, "writePtr", writeTyped<intptr_t, double>, data);
+  setMethod(exports, "writeBool", writeTyped<bool, bool>, data);
+}
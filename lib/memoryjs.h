@@ -15,6 +15,7 @@ public:
   ~memoryjs();
 
   static void throwError(char* error, Isolate* isolate);
+  static void* getViewData(v8::Local<v8::ArrayBufferView> view);
 };
 #endif
 #pragma once
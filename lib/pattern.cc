@@ -1,61 +1,160 @@
 #include <node.h>
 #include <windows.h>
 #include <TlHelp32.h>
+#include <algorithm>
 #include <vector>
 #include "pattern.h"
 #include "memoryjs.h"
 #include "process.h"
 #include "memory.h"
-
-#define INRANGE(x,a,b) (x >= a && x <= b) 
-#define getBits( x ) (INRANGE(x,'0','9') ? (x - '0') : ((x&(~0x20)) - 'A' + 0xa))
-#define getByte( x ) (getBits(x[0]) << 4 | getBits(x[1]))
+#include "reader.h"
+#include "scancontrol.h"
+#include "signature.h"
 
 pattern::pattern() {}
 pattern::~pattern() {}
 
 using v8::Object;
 
-/* based off Y3t1y3t's implementation */
-uintptr_t pattern::findPattern(HANDLE handle, MODULEENTRY32 module, const char* pattern, short sigType, uintptr_t patternOffset, uintptr_t addressOffset) { 
-  auto moduleSize = uintptr_t(module.modBaseSize);
+/* based off Y3t1y3t's implementation
+ * Scans ranges of the module (in address order), and fallbackRanges only if there was no match in ranges.
+ * If the scan is stopped by the control before it completes, complete is set to false and the
+ * best match found so far (if any) is returned. Returns -3 if an operation of the signature
+ * could not read the memory it needed and -4 if no read buffer could be allocated for the scan,
+ * captures receives the address of every capture. */
+uintptr_t pattern::findPattern(HANDLE handle, MODULEENTRY32 module, const std::vector<reader::Range>& ranges, const std::vector<reader::Range>& fallbackRanges,
+  const signature& pattern, short sigType, uintptr_t patternOffset, uintptr_t addressOffset,
+  reader& Reader, scancontrol* control, bool* complete, std::vector<uintptr_t>* captures) {
   auto moduleBase = uintptr_t(module.hModule);
 
-  auto moduleBytes = std::vector<unsigned char>(moduleSize);
-  ReadProcessMemory(handle, LPCVOID(moduleBase), &moduleBytes[0], moduleSize, nullptr);
+  auto totalSize = [](const std::vector<reader::Range>& list) {
+    SIZE_T size = 0;
+    for (std::vector<reader::Range>::size_type i = 0; i != list.size(); i++) size += list[i].size;
+    return size;
+  };
+
+  *complete = true;
 
-  auto byteBase = const_cast<unsigned char*>(&moduleBytes.at(0));
-  auto maxOffset = moduleSize - 0x1000;
+  if (control != nullptr) control->begin(totalSize(ranges));
 
-  for (auto offset = 0UL; offset < maxOffset; ++offset) {
-    if (compareBytes(byteBase + offset, pattern)) {
-      auto address = moduleBase + offset + patternOffset;
+  uintptr_t matchAddress = 0;
+  std::vector<SIZE_T> matchPositions(pattern.getPositionCount());
 
-      /* read memory at pattern if flag is raised*/
-      if (sigType & ST_READ) ReadProcessMemory(handle, LPCVOID(address), &address, sizeof(uintptr_t), nullptr);
+  char* errorMessage = "";
+  bool found = scanRanges(handle, ranges, pattern, Reader, control, &matchAddress, matchPositions, &errorMessage);
 
-      /* subtract image base if flag is raised */
-      if (sigType & ST_SUBTRACT) address -= moduleBase;
+  if (!found && !fallbackRanges.empty() && !strcmp(errorMessage, "") && (control == nullptr || !control->wasStopped())) {
+    // fallback ranges adjoin the ranges already scanned, they start maxSize - 1 bytes early and end
+    // maxSize - 1 bytes late (within the module) so matches that cross from one into the other are found too
+    std::vector<reader::Range> extended(fallbackRanges);
+    uintptr_t moduleEnd = moduleBase + module.modBaseSize;
 
-      return address + addressOffset;
+    for (std::vector<reader::Range>::size_type i = 0; i != extended.size(); i++) {
+      SIZE_T before = (std::min)((SIZE_T)(pattern.getMaxSize() - 1), (SIZE_T)(extended[i].address - moduleBase));
+      SIZE_T after = (std::min)((SIZE_T)(pattern.getMaxSize() - 1), (SIZE_T)(moduleEnd - (extended[i].address + extended[i].size)));
+      extended[i].address -= before;
+      extended[i].size += before + after;
     }
+
+    if (control != nullptr) control->extend(totalSize(extended));
+    found = scanRanges(handle, extended, pattern, Reader, control, &matchAddress, matchPositions, &errorMessage);
   }
 
-  // the method that calls this will check to see if the value is -2
-	// and throw a 'no match' error
-  return -2;
-};
+  if (control != nullptr) {
+    *complete = !control->wasStopped();
+    control->reportProgress(true);
+  }
 
-bool pattern::compareBytes(const unsigned char* bytes, const char* pattern) {
-  for (; *pattern; *pattern != ' ' ? ++bytes : bytes, ++pattern) {
-    if (*pattern == ' ' || *pattern == '?')
-      continue;
-		
-    if (*bytes != getByte(pattern))
-      return false;
-    
-    ++pattern;
+  // running out of buffers is not a miss, the method that calls this throws it as an error
+  if (!found && strcmp(errorMessage, "")) return -4;
+
+  if (!found) {
+    // the method that calls this will check to see if the value is -2
+    // and throw a 'no match' error
+    return -2;
   }
-  
-  return true;
-}
\ No newline at end of file
+
+  if (captures != nullptr) {
+    captures->resize(pattern.captureNames.size());
+
+    for (std::vector<uintptr_t>::size_type i = 0; i != captures->size(); i++) {
+      (*captures)[i] = matchAddress + pattern.getCaptureOffset(&matchPositions[0], (int)i);
+    }
+  }
+
+  auto address = matchAddress;
+
+  /* post-operations of the signature, e.g. following a call or a RIP relative operand */
+  for (std::vector<signature::Operation>::size_type i = 0; i != pattern.operations.size(); i++) {
+    const signature::Operation& operation = pattern.operations[i];
+
+    if (operation.capture != -1) address = matchAddress + pattern.getCaptureOffset(&matchPositions[0], operation.capture);
+
+    if (operation.type == signature::Operation::OP_REL32) {
+      int32_t displacement;
+      if (!ReadProcessMemory(handle, LPCVOID(address), &displacement, sizeof(int32_t), nullptr)) return -3;
+      address += operation.value + displacement;
+    } else if (operation.type == signature::Operation::OP_DEREF) {
+      for (SIZE_T j = 0; j < operation.value; j++) {
+        if (!ReadProcessMemory(handle, LPCVOID(address), &address, sizeof(uintptr_t), nullptr)) return -3;
+      }
+    }
+  }
+
+  address += patternOffset;
+
+  /* read memory at pattern if flag is raised*/
+  if (sigType & ST_READ) ReadProcessMemory(handle, LPCVOID(address), &address, sizeof(uintptr_t), nullptr);
+
+  /* subtract image base if flag is raised */
+  if (sigType & ST_SUBTRACT) address -= moduleBase;
+
+  return address + addressOffset;
+};
+
+/* Ranges are read in chunks that are scanned as soon as they arrive, each chunk includes the first
+ * maxSize - 1 bytes of the next one so matches across chunk boundaries are found.
+ * Returns true if there was a match, matchAddress and matchPositions receive the one with the lowest address.
+ * errorMessage is set if the ranges could not be read because no read buffer could be allocated. */
+bool pattern::scanRanges(HANDLE handle, const std::vector<reader::Range>& ranges, const signature& pattern, reader& Reader, scancontrol* control,
+  uintptr_t* matchAddress, std::vector<SIZE_T>& matchPositions, char** errorMessage) {
+  auto minSize = pattern.getMinSize();
+  auto maxSize = pattern.getMaxSize();
+
+  // chunks can complete out of order, the match with the lowest address wins
+  // so scanning only stops once every chunk before the best match has been scanned
+  const SIZE_T noMatch = (SIZE_T)-1;
+  SIZE_T matchChunk = noMatch;
+  std::vector<bool> scanned;
+
+  // offsets of the elements of the current match
+  std::vector<SIZE_T> positions(pattern.getPositionCount());
+
+  Reader.readRanges(handle, ranges, maxSize - 1, [&](const reader::Chunk& chunk) {
+    if (scanned.size() <= chunk.index) scanned.resize(chunk.index + 1, false);
+    scanned[chunk.index] = true;
+
+    if (chunk.success && chunk.index < matchChunk && chunk.available >= minSize) {
+      auto lastOffset = chunk.available - minSize;
+      if (lastOffset >= chunk.size) lastOffset = chunk.size - 1;
+
+      SIZE_T offset = pattern.find(chunk.data, chunk.available, lastOffset, &positions[0]);
+
+      if (offset != noMatch) {
+        matchChunk = chunk.index;
+        *matchAddress = chunk.address + offset;
+        matchPositions.swap(positions);
+      }
+    }
+
+    if (matchChunk == noMatch) return true;
+
+    for (SIZE_T i = 0; i < matchChunk; i++) {
+      if (i >= scanned.size() || !scanned[i]) return true;
+    }
+
+    return false;
+  }, control, errorMessage);
+
+  return matchChunk != noMatch;
+}
@@ -6,6 +6,11 @@
 #include <node.h>
 #include <windows.h>
 #include <TlHelp32.h>
+#include <vector>
+#include "reader.h"
+#include "signature.h"
+#include "scancontrol.h"
+
 class pattern {
 
 public:
@@ -22,8 +27,13 @@ public:
     ST_SUBTRACT = 0x2
   };
 
-  uintptr_t findPattern(HANDLE handle, MODULEENTRY32 module, const char* pattern, short sigType, uintptr_t patternOffset, uintptr_t addressOffset);
-  bool compareBytes(const unsigned char* bytes, const char* pattern);
+  uintptr_t findPattern(HANDLE handle, MODULEENTRY32 module, const std::vector<reader::Range>& ranges, const std::vector<reader::Range>& fallbackRanges,
+    const signature& pattern, short sigType, uintptr_t patternOffset, uintptr_t addressOffset,
+    reader& Reader, scancontrol* control, bool* complete, std::vector<uintptr_t>* captures);
+
+private:
+  bool scanRanges(HANDLE handle, const std::vector<reader::Range>& ranges, const signature& pattern, reader& Reader, scancontrol* control,
+    uintptr_t* matchAddress, std::vector<SIZE_T>& matchPositions, char** errorMessage);
 };
 #endif
 #pragma once
@@ -0,0 +1,393 @@
+#include <node.h>
+#include <windows.h>
+#include <TlHelp32.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "pointerscan.h"
+#include "memory.h"
+
+pointerscan::pointerscan() {}
+pointerscan::~pointerscan() {}
+
+// Identifies an index file and the pointer size it was created with
+static const char INDEX_MAGIC[4] = { 'M', 'J', 'P', 'I' };
+static const DWORD INDEX_VERSION = 1;
+
+/* Builds the reverse pointer index of a process: every aligned value in a writable region
+ * that points into a readable region. Regions are read in chunks on the scheduler's workers
+ * and the entries are sorted by value once all chunks are done.
+ * Fails if more than maxEntries pointers are found, to keep the index within its memory budget.
+ * If the control stops the build early the index only covers the regions read so far. */
+bool pointerscan::buildIndex(HANDLE handle, SIZE_T maxEntries, std::vector<Entry>& index, bufferpool& pool, scheduler::Priority priority,
+  scancontrol* control, char** errorMessage) {
+  std::vector<memory::Region> targets = memory::getRegions(handle, false);
+  std::vector<memory::Region> sources = memory::getRegions(handle, true);
+
+  if (targets.empty()) {
+    *errorMessage = "unable to query the memory regions of the process";
+    return false;
+  }
+
+  // getRegions returns regions in address order, so pointers can be validated with a binary search
+  uintptr_t lowest = targets.front().base;
+  uintptr_t highest = targets.back().base + targets.back().size;
+
+  auto isValidPointer = [&](uintptr_t value) {
+    if (value < lowest || value >= highest) return false;
+
+    auto region = std::upper_bound(targets.begin(), targets.end(), value, [](uintptr_t value, const memory::Region& region) {
+      return value < region.base;
+    });
+
+    if (region == targets.begin()) return false;
+    --region;
+    return value < region->base + region->size;
+  };
+
+  if (control != nullptr) {
+    SIZE_T bytesTotal = 0;
+    for (std::vector<memory::Region>::size_type i = 0; i != sources.size(); i++) bytesTotal += sources[i].size;
+    control->begin(bytesTotal);
+  }
+
+  // regions are read in chunks on the shared scheduler, with at most one chunk per worker
+  // in flight so other work of the same priority still gets its turn
+  struct Piece {
+    uintptr_t base;
+    SIZE_T size;
+  };
+
+  std::vector<Piece> pieces;
+
+  for (std::vector<memory::Region>::size_type i = 0; i != sources.size(); i++) {
+    for (SIZE_T offset = 0; offset < sources[i].size; offset += CHUNK_SIZE) {
+      Piece piece = { sources[i].base + offset, (std::min)(CHUNK_SIZE, sources[i].size - offset) };
+      pieces.push_back(piece);
+    }
+  }
+
+  // pieces are appended to the index as they finish, so only the pieces in flight are held twice
+  index.clear();
+  std::atomic<size_t> totalEntries(0);
+  std::atomic<bool> overBudget(false);
+  std::atomic<bool> noBuffer(false);
+  std::mutex indexLock;
+
+  std::mutex lock;
+  std::condition_variable pieceDone;
+  SIZE_T inFlight = 0;
+
+  auto stopRequested = [&]() {
+    return overBudget || noBuffer || (control != nullptr && control->shouldStop());
+  };
+
+  auto readPiece = [&](size_t i) {
+    bufferpool::Lease buffer;
+    if (!stopRequested()) {
+      buffer.acquire(&pool, CHUNK_SIZE);
+
+      // a piece that couldn't be read would silently be missing from the index
+      if (buffer.data == nullptr) noBuffer = true;
+    }
+
+    if (buffer.data != nullptr) {
+      const uintptr_t* chunk = reinterpret_cast<const uintptr_t*>(buffer.data);
+      const Piece& piece = pieces[i];
+
+      if (control != nullptr) control->advance(piece.size);
+
+      if (memory::readBuffer(handle, piece.base, buffer.data, piece.size)) {
+        std::vector<Entry> found;
+
+        for (SIZE_T j = 0; j < piece.size / sizeof(uintptr_t) && !overBudget; j++) {
+          if (!isValidPointer(chunk[j])) continue;
+
+          Entry entry = { chunk[j], piece.base + j * sizeof(uintptr_t) };
+          found.push_back(entry);
+
+          // entries are counted against the budget in batches, so every piece stops soon after it is exceeded
+          if ((found.size() & 0xFFF) == 0 && (totalEntries += 0x1000) > maxEntries) overBudget = true;
+        }
+
+        totalEntries += found.size() & 0xFFF;
+        if (totalEntries > maxEntries) overBudget = true;
+
+        if (!overBudget) {
+          std::lock_guard<std::mutex> indexGuard(indexLock);
+
+          // grow up to the budget at most
+          if (index.size() + found.size() > index.capacity()) {
+            index.reserve((std::min)((std::max)(index.size() + found.size(), index.capacity() * 2), maxEntries));
+          }
+
+          index.insert(index.end(), found.begin(), found.end());
+        }
+      }
+    }
+
+    // notified under the lock: the caller returns (destroying the lock) as soon as inFlight is 0
+    std::lock_guard<std::mutex> guard(lock);
+    inFlight--;
+    pieceDone.notify_one();
+  };
+
+  SIZE_T slots = scheduler::get().getThreadCount();
+  std::vector<Piece>::size_type next = 0;
+  std::unique_lock<std::mutex> guard(lock);
+
+  while (true) {
+    while (next < pieces.size() && inFlight < slots && !stopRequested()) {
+      size_t i = next++;
+      inFlight++;
+      scheduler::get().submit(handle, priority, [&readPiece, i]() { readPiece(i); });
+    }
+
+    if (inFlight == 0) break;
+
+    pieceDone.wait_for(guard, std::chrono::milliseconds(10));
+
+    // progress callbacks have to run on the calling thread
+    if (control != nullptr) {
+      guard.unlock();
+      control->reportProgress(false);
+      guard.lock();
+    }
+  }
+
+  guard.unlock();
+  if (control != nullptr) control->reportProgress(true);
+
+  if (overBudget || noBuffer) {
+    std::vector<Entry>().swap(index);
+    *errorMessage = overBudget ? "pointer index exceeds the memory budget" : "unable to allocate a read buffer";
+    return false;
+  }
+
+  std::sort(index.begin(), index.end(), [](const Entry& a, const Entry& b) {
+    return a.value < b.value || (a.value == b.value && a.address < b.address);
+  });
+
+  return true;
+}
+
+/* Finds chains that end at target and start at an address inside a module image.
+ * Works backwards from the target: every pointer to somewhere in [target - maxOffset, target]
+ * is one level of the chain, pointers stored inside a module end the chain.
+ * At most maxNodes index entries are expanded, complete is set to false if the search was
+ * cut short by that limit or by the control. */
+std::vector<pointerscan::Chain> pointerscan::scan(const std::vector<Entry>& index, const std::vector<MODULEENTRY32>& modules,
+  uintptr_t target, int maxDepth, uintptr_t maxOffset, SIZE_T maxResults, SIZE_T maxNodes, scancontrol* control, bool* complete) {
+  std::vector<Chain> results;
+
+  Search state;
+  state.index = &index;
+  state.modules = &modules;
+  state.maxDepth = maxDepth;
+  state.maxOffset = maxOffset;
+  state.maxResults = maxResults;
+  state.maxNodes = maxNodes;
+  state.control = control;
+  state.results = &results;
+  state.nodes = 0;
+  state.stopped = control != nullptr && control->shouldStop();
+
+  if (!state.stopped) search(state, target, 0);
+  if (control != nullptr) control->reportProgress(true);
+
+  *complete = !state.stopped;
+  return results;
+}
+
+/* Returns false if part of the search below target was skipped (a cycle, or the search was stopped),
+ * then finding nothing doesn't make target a dead end. */
+bool pointerscan::search(Search& state, uintptr_t target, int depth) {
+  std::unordered_map<uintptr_t, int>::iterator deadEnd = state.deadEnds.find(target);
+  if (deadEnd != state.deadEnds.end() && deadEnd->second <= depth) return true;
+
+  const std::vector<Entry>& index = *state.index;
+  uintptr_t lowest = target > state.maxOffset ? target - state.maxOffset : 0;
+
+  auto first = std::lower_bound(index.begin(), index.end(), lowest, [](const Entry& entry, uintptr_t value) {
+    return entry.value < value;
+  });
+
+  SIZE_T resultsBefore = state.results->size();
+  bool exhaustive = true;
+  state.path.insert(target);
+
+  for (auto entry = first; entry != index.end() && entry->value <= target; ++entry) {
+    if (state.results->size() >= state.maxResults) {
+      exhaustive = false;
+      break;
+    }
+
+    if (++state.nodes > state.maxNodes) state.stopped = true;
+
+    // the control is checked every few thousand entries, progress callbacks run on this thread
+    if (state.control != nullptr && (state.nodes & 0xFFF) == 0) {
+      state.control->reportProgress(false);
+      if (state.control->shouldStop()) state.stopped = true;
+    }
+
+    if (state.stopped) {
+      exhaustive = false;
+      break;
+    }
+
+    state.offsets.push_back(target - entry->value);
+
+    const MODULEENTRY32* module = findStaticModule(*state.modules, entry->address);
+
+    if (module != nullptr) {
+      // offsets were collected from the target upwards, chains are resolved from the base down
+      Chain chain;
+      chain.module = module->szModule;
+      chain.baseOffset = entry->address - (uintptr_t)module->modBaseAddr;
+      chain.offsets.assign(state.offsets.rbegin(), state.offsets.rend());
+      state.results->push_back(chain);
+    } else if (depth + 1 < state.maxDepth) {
+      if (state.path.count(entry->address)) exhaustive = false;
+      else if (!search(state, entry->address, depth + 1)) exhaustive = false;
+    }
+
+    state.offsets.pop_back();
+  }
+
+  state.path.erase(target);
+
+  if (exhaustive && state.results->size() == resultsBefore) {
+    deadEnd = state.deadEnds.find(target);
+    if (deadEnd == state.deadEnds.end() || depth < deadEnd->second) state.deadEnds[target] = depth;
+  }
+
+  return exhaustive;
+}
+
+const MODULEENTRY32* pointerscan::findStaticModule(const std::vector<MODULEENTRY32>& modules, uintptr_t address) {
+  for (std::vector<MODULEENTRY32>::size_type i = 0; i != modules.size(); i++) {
+    uintptr_t base = (uintptr_t)modules[i].modBaseAddr;
+    if (address >= base && address < base + modules[i].modBaseSize) return &modules[i];
+  }
+
+  return nullptr;
+}
+
+/* Follows a chain, returns false if one of the pointers along the way can't be read */
+bool pointerscan::resolve(HANDLE handle, const Chain& chain, uintptr_t moduleBase, uintptr_t* address) {
+  uintptr_t current = moduleBase + chain.baseOffset;
+
+  for (std::vector<uintptr_t>::size_type i = 0; i != chain.offsets.size(); i++) {
+    uintptr_t pointer;
+    if (!memory::readBuffer(handle, current, &pointer, sizeof(pointer))) return false;
+    current = pointer + chain.offsets[i];
+  }
+
+  *address = current;
+  return true;
+}
+
+/* Keeps the chains that still lead to target (e.g. after the process has been restarted) */
+std::vector<pointerscan::Chain> pointerscan::rescan(HANDLE handle, const std::vector<Chain>& chains, const std::vector<MODULEENTRY32>& modules, uintptr_t target) {
+  std::vector<Chain> results;
+
+  for (std::vector<Chain>::size_type i = 0; i != chains.size(); i++) {
+    for (std::vector<MODULEENTRY32>::size_type j = 0; j != modules.size(); j++) {
+      if (strcmp(modules[j].szModule, chains[i].module.c_str())) continue;
+
+      uintptr_t address;
+      if (resolve(handle, chains[i], (uintptr_t)modules[j].modBaseAddr, &address) && address == target) {
+        results.push_back(chains[i]);
+      }
+
+      break;
+    }
+  }
+
+  return results;
+}
+
+bool pointerscan::saveIndex(const char* path, const std::vector<Entry>& index, char** errorMessage) {
+  FILE* file = fopen(path, "wb");
+
+  if (file == nullptr) {
+    *errorMessage = "unable to open the index file for writing";
+    return false;
+  }
+
+  DWORD pointerSize = sizeof(uintptr_t);
+  DWORD64 count = index.size();
+
+  bool success = fwrite(INDEX_MAGIC, sizeof(INDEX_MAGIC), 1, file) == 1
+    && fwrite(&INDEX_VERSION, sizeof(INDEX_VERSION), 1, file) == 1
+    && fwrite(&pointerSize, sizeof(pointerSize), 1, file) == 1
+    && fwrite(&count, sizeof(count), 1, file) == 1
+    && (count == 0 || fwrite(&index[0], sizeof(Entry), index.size(), file) == index.size());
+
+  if (fclose(file) != 0) success = false;
+
+  if (!success) *errorMessage = "unable to write the index file";
+  return success;
+}
+
+/* Loads an index written by saveIndex. The entry count is checked against the size of the file and
+ * maxEntries before anything is allocated, and the entries have to be sorted like buildIndex sorts them. */
+bool pointerscan::loadIndex(const char* path, SIZE_T maxEntries, std::vector<Entry>& index, char** errorMessage) {
+  FILE* file = fopen(path, "rb");
+
+  if (file == nullptr) {
+    *errorMessage = "unable to open the index file for reading";
+    return false;
+  }
+
+  char magic[4];
+  DWORD version;
+  DWORD pointerSize;
+  DWORD64 count;
+
+  bool success = fread(magic, sizeof(magic), 1, file) == 1
+    && fread(&version, sizeof(version), 1, file) == 1
+    && fread(&pointerSize, sizeof(pointerSize), 1, file) == 1
+    && fread(&count, sizeof(count), 1, file) == 1
+    && !memcmp(magic, INDEX_MAGIC, sizeof(magic))
+    && version == INDEX_VERSION
+    && pointerSize == sizeof(uintptr_t);
+
+  // the entries have to fill the rest of the file exactly
+  LONGLONG position = success ? _ftelli64(file) : -1;
+  LONGLONG fileSize = position >= 0 && _fseeki64(file, 0, SEEK_END) == 0 ? _ftelli64(file) : -1;
+
+  success = success && fileSize >= position && _fseeki64(file, position, SEEK_SET) == 0
+    && count == (DWORD64)(fileSize - position) / sizeof(Entry)
+    && (DWORD64)(fileSize - position) % sizeof(Entry) == 0;
+
+  if (success && count > maxEntries) {
+    fclose(file);
+    *errorMessage = "pointer index exceeds the memory budget";
+    return false;
+  }
+
+  if (success) {
+    index.resize((size_t)count);
+    success = count == 0 || fread(&index[0], sizeof(Entry), index.size(), file) == index.size();
+  }
+
+  // the search looks entries up with a binary search on their value
+  for (std::vector<Entry>::size_type i = 1; success && i < index.size(); i++) {
+    success = index[i - 1].value <= index[i].value;
+  }
+
+  fclose(file);
+
+  if (!success) {
+    std::vector<Entry>().swap(index);
+    *errorMessage = "invalid index file";
+  }
+
+  return success;
+}
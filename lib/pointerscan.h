@@ -0,0 +1,80 @@
+#pragma once
+#ifndef POINTERSCAN_H
+#define POINTERSCAN_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <TlHelp32.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "memory.h"
+#include "bufferpool.h"
+#include "scancontrol.h"
+#include "scheduler.h"
+
+class pointerscan {
+
+public:
+  pointerscan();
+  ~pointerscan();
+
+  // A pointer found in memory: `value` is stored at `address`.
+  // The index is a vector of these sorted by value.
+  struct Entry {
+    uintptr_t value;
+    uintptr_t address;
+  };
+
+  // A path to an address: read the pointer at module + baseOffset,
+  // then for every offset add it and (except for the last one) read the pointer there
+  struct Chain {
+    std::string module;
+    uintptr_t baseOffset;
+    std::vector<uintptr_t> offsets;
+  };
+
+  // Bytes read at once from a region while building the index
+  static const SIZE_T CHUNK_SIZE = 1024 * 1024;
+
+  // Default limit on the index entries one search expands, the search grows exponentially with maxDepth
+  static const SIZE_T DEFAULT_MAX_NODES = 10000000;
+
+  bool buildIndex(HANDLE handle, SIZE_T maxEntries, std::vector<Entry>& index, bufferpool& pool, scheduler::Priority priority,
+    scancontrol* control, char** errorMessage);
+  std::vector<Chain> scan(const std::vector<Entry>& index, const std::vector<MODULEENTRY32>& modules,
+    uintptr_t target, int maxDepth, uintptr_t maxOffset, SIZE_T maxResults, SIZE_T maxNodes, scancontrol* control, bool* complete);
+  std::vector<Chain> rescan(HANDLE handle, const std::vector<Chain>& chains, const std::vector<MODULEENTRY32>& modules, uintptr_t target);
+  bool resolve(HANDLE handle, const Chain& chain, uintptr_t moduleBase, uintptr_t* address);
+
+  bool saveIndex(const char* path, const std::vector<Entry>& index, char** errorMessage);
+  bool loadIndex(const char* path, SIZE_T maxEntries, std::vector<Entry>& index, char** errorMessage);
+
+private:
+  struct Search {
+    const std::vector<Entry>* index;
+    const std::vector<MODULEENTRY32>* modules;
+    int maxDepth;
+    uintptr_t maxOffset;
+    SIZE_T maxResults;
+    SIZE_T maxNodes;
+    scancontrol* control;
+    std::vector<uintptr_t> offsets;
+    std::vector<Chain>* results;
+
+    // entries expanded so far, and whether the search was cut short by maxNodes or the control
+    SIZE_T nodes;
+    bool stopped;
+    // targets on the current path, following them again would only go round a cycle
+    std::unordered_set<uintptr_t> path;
+    // targets that lead to no chains when reached at this depth (or any deeper one)
+    std::unordered_map<uintptr_t, int> deadEnds;
+  };
+
+  bool search(Search& state, uintptr_t target, int depth);
+  static const MODULEENTRY32* findStaticModule(const std::vector<MODULEENTRY32>& modules, uintptr_t address);
+};
+#endif
+#pragma once
@@ -0,0 +1,234 @@
+#include <node.h>
+#include <windows.h>
+#include <memory>
+#include <vector>
+#include "reader.h"
+
+reader::reader(bufferpool& pool) : queueDepth(DEFAULT_QUEUE_DEPTH), chunkSize(DEFAULT_CHUNK_SIZE),
+  readPriority(scheduler::PRIORITY_NORMAL), scanPriority(scheduler::PRIORITY_BACKGROUND), pool(pool) {}
+
+reader::~reader() {}
+
+/* Changes the number of reads kept in flight and the size of each read */
+void reader::configure(SIZE_T queueDepth, SIZE_T chunkSize) {
+  std::lock_guard<std::mutex> guard(settings);
+
+  this->queueDepth = queueDepth < 1 ? 1 : queueDepth;
+  this->chunkSize = chunkSize < 0x1000 ? 0x1000 : chunkSize;
+
+  // chunks start a multiple of chunkSize into their range, an even size keeps UTF-16 characters aligned
+  this->chunkSize &= ~(SIZE_T)1;
+}
+
+SIZE_T reader::getQueueDepth() {
+  std::lock_guard<std::mutex> guard(settings);
+  return queueDepth;
+}
+
+SIZE_T reader::getChunkSize() {
+  std::lock_guard<std::mutex> guard(settings);
+  return chunkSize;
+}
+
+void reader::setPriorities(scheduler::Priority readPriority, scheduler::Priority scanPriority) {
+  std::lock_guard<std::mutex> guard(settings);
+
+  this->readPriority = readPriority;
+  this->scanPriority = scanPriority;
+}
+
+scheduler::Priority reader::getReadPriority() {
+  std::lock_guard<std::mutex> guard(settings);
+  return readPriority;
+}
+
+scheduler::Priority reader::getScanPriority() {
+  std::lock_guard<std::mutex> guard(settings);
+  return scanPriority;
+}
+
+void reader::submit(Batch& batch, const Job& job, scheduler::Priority priority) {
+  Batch* target = &batch;
+
+  scheduler::get().submit(job.handle, priority, [target, job]() {
+    Job done = job;
+    SIZE_T bytesRead = 0;
+    done.chunk.success = ReadProcessMemory(done.handle, LPCVOID(done.chunk.address), done.destination, done.chunk.available, &bytesRead)
+      && bytesRead == done.chunk.available;
+
+    // notified under the lock: once the caller sees its last job the batch may be destroyed
+    std::lock_guard<std::mutex> guard(target->lock);
+    target->completed.push_back(done);
+    target->jobDone.notify_one();
+  });
+}
+
+reader::Job reader::wait(Batch& batch) {
+  std::unique_lock<std::mutex> guard(batch.lock);
+  batch.jobDone.wait(guard, [&batch] { return !batch.completed.empty(); });
+
+  Job job = batch.completed.front();
+  batch.completed.pop_front();
+  return job;
+}
+
+/* Reads every range in chunks of chunkSize (plus `overlap` bytes so matches that cross
+ * a chunk boundary can be found) and calls onChunk for each chunk as it completes.
+ * Chunks are not necessarily delivered in address order, Chunk::index gives their position.
+ * If a control is given, progress is reported after every chunk and reading stops when it is
+ * cancelled or out of time. Returns false if onChunk or the control stopped the read, or if not even
+ * one read buffer could be allocated, in which case errorMessage is set.
+ * No lock is held while onChunk runs, so it may call the reader again. */
+bool reader::readRanges(HANDLE handle, const std::vector<Range>& ranges, SIZE_T overlap, const ChunkCallback& onChunk, scancontrol* control,
+  char** errorMessage) {
+  SIZE_T queueDepth;
+  SIZE_T chunkSize;
+  scheduler::Priority scanPriority;
+
+  {
+    std::lock_guard<std::mutex> guard(settings);
+    queueDepth = this->queueDepth;
+    chunkSize = this->chunkSize;
+    scanPriority = this->scanPriority;
+  }
+
+  std::vector<Job> plan;
+
+  for (std::vector<Range>::size_type r = 0; r != ranges.size(); r++) {
+    uintptr_t end = ranges[r].address + ranges[r].size;
+
+    for (uintptr_t address = ranges[r].address; address < end; address += chunkSize) {
+      Job job;
+      job.handle = handle;
+      job.chunk.range = r;
+      job.chunk.index = plan.size();
+      job.chunk.address = address;
+      job.chunk.size = end - address < chunkSize ? end - address : chunkSize;
+      job.chunk.available = end - address < chunkSize + overlap ? end - address : chunkSize + overlap;
+      job.chunk.success = false;
+      plan.push_back(job);
+    }
+  }
+
+  if (plan.empty()) return true;
+
+  SIZE_T bufferSize = chunkSize + overlap;
+
+  // A single chunk isn't worth handing to another thread
+  if (plan.size() == 1) {
+    bufferpool::Lease buffer(&pool, plan[0].chunk.available);
+    Chunk& chunk = plan[0].chunk;
+    SIZE_T bytesRead = 0;
+
+    if (buffer.data == nullptr) {
+      *errorMessage = "unable to allocate a read buffer";
+      return false;
+    }
+
+    chunk.success = ReadProcessMemory(handle, LPCVOID(chunk.address), buffer.data, chunk.available, &bytesRead) && bytesRead == chunk.available;
+    chunk.data = buffer.data;
+
+    bool keepGoing = onChunk(chunk);
+    if (control != nullptr) {
+      control->advance(chunk.size);
+      control->reportProgress(false);
+    }
+
+    return keepGoing;
+  }
+
+  SIZE_T slotCount = queueDepth < plan.size() ? queueDepth : plan.size();
+  std::unique_ptr<bufferpool::Lease[]> buffers(new bufferpool::Lease[slotCount]);
+  std::vector<SIZE_T> freeSlots;
+
+  // with fewer buffers than the queue depth (the pool is at its limit) fewer reads are kept in flight
+  for (SIZE_T i = 0; i < slotCount; i++) {
+    buffers[i].acquire(&pool, bufferSize);
+    if (buffers[i].data == nullptr) break;
+    freeSlots.push_back(i);
+  }
+
+  if (freeSlots.empty()) {
+    *errorMessage = "unable to allocate a read buffer";
+    return false;
+  }
+
+  Batch batch;
+  std::vector<Job>::size_type next = 0;
+  SIZE_T inFlight = 0;
+  bool keepGoing = control == nullptr || !control->shouldStop();
+
+  while (next < plan.size() && !freeSlots.empty()) {
+    plan[next].slot = freeSlots.back();
+    plan[next].destination = buffers[plan[next].slot].data;
+    freeSlots.pop_back();
+    submit(batch, plan[next++], scanPriority);
+    inFlight++;
+  }
+
+  while (inFlight > 0) {
+    Job job = wait(batch);
+    inFlight--;
+
+    if (keepGoing) {
+      job.chunk.data = job.destination;
+      keepGoing = onChunk(job.chunk);
+
+      if (control != nullptr) {
+        control->advance(job.chunk.size);
+        control->reportProgress(false);
+        if (control->shouldStop()) keepGoing = false;
+      }
+    }
+
+    // reuse the slot for the next chunk
+    if (keepGoing && next < plan.size()) {
+      plan[next].slot = job.slot;
+      plan[next].destination = job.destination;
+      submit(batch, plan[next++], scanPriority);
+      inFlight++;
+    }
+  }
+
+  return keepGoing;
+}
+
+/* Reads a large block straight into output, with all chunks in flight at once */
+bool reader::readInto(HANDLE handle, uintptr_t address, SIZE_T size, unsigned char* output) {
+  SIZE_T chunkSize;
+  scheduler::Priority readPriority;
+
+  {
+    std::lock_guard<std::mutex> guard(settings);
+    chunkSize = this->chunkSize;
+    readPriority = this->readPriority;
+  }
+
+  if (size <= chunkSize) {
+    SIZE_T bytesRead = 0;
+    return ReadProcessMemory(handle, LPCVOID(address), output, size, &bytesRead) && bytesRead == size;
+  }
+
+  Batch batch;
+  SIZE_T inFlight = 0;
+
+  for (SIZE_T offset = 0; offset < size; offset += chunkSize) {
+    Job job;
+    job.handle = handle;
+    job.chunk.index = inFlight;
+    job.chunk.address = address + offset;
+    job.chunk.size = job.chunk.available = size - offset < chunkSize ? size - offset : chunkSize;
+    job.chunk.success = false;
+    job.destination = output + offset;
+    submit(batch, job, readPriority);
+    inFlight++;
+  }
+
+  bool success = true;
+
+  for (; inFlight > 0; inFlight--) {
+    if (!wait(batch).chunk.success) success = false;
+  }
+
+  return success;
+}
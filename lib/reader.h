@@ -0,0 +1,93 @@
+#pragma once
+#ifndef READER_H
+#define READER_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "bufferpool.h"
+#include "scancontrol.h"
+#include "scheduler.h"
+
+/* Bulk reader: splits large reads into chunks and keeps up to queueDepth of them in flight
+ * on the shared scheduler's workers. Completed chunks are handed to the caller (on the calling thread)
+ * as they arrive, so the caller can process one chunk while the next ones are being read.
+ * readInto is scheduled with the read priority, readRanges (used by scans) with the scan priority.
+ * Reads of at most one chunk are done on the calling thread and never queued, the priorities don't apply to them. */
+class reader {
+
+public:
+  reader(bufferpool& pool);
+  ~reader();
+
+  struct Range {
+    uintptr_t address;
+    SIZE_T size;
+  };
+
+  // A completed chunk. `data` holds `available` bytes starting at `address`: the chunk's own
+  // `size` bytes plus up to `overlap` bytes of the next chunk in the same range.
+  struct Chunk {
+    SIZE_T range;
+    SIZE_T index;
+    uintptr_t address;
+    SIZE_T size;
+    SIZE_T available;
+    const unsigned char* data;
+    bool success;
+  };
+
+  // Return false to stop reading, chunks that are already in flight are discarded
+  typedef std::function<bool(const Chunk&)> ChunkCallback;
+
+  static const SIZE_T DEFAULT_QUEUE_DEPTH = 8;
+  static const SIZE_T DEFAULT_CHUNK_SIZE = 1024 * 1024;
+
+  void configure(SIZE_T queueDepth, SIZE_T chunkSize);
+  SIZE_T getQueueDepth();
+  SIZE_T getChunkSize();
+
+  void setPriorities(scheduler::Priority readPriority, scheduler::Priority scanPriority);
+  scheduler::Priority getReadPriority();
+  scheduler::Priority getScanPriority();
+
+  bool readRanges(HANDLE handle, const std::vector<Range>& ranges, SIZE_T overlap, const ChunkCallback& onChunk, scancontrol* control,
+    char** errorMessage);
+  bool readInto(HANDLE handle, uintptr_t address, SIZE_T size, unsigned char* output);
+
+private:
+  struct Job {
+    HANDLE handle;
+    Chunk chunk;
+    SIZE_T slot;
+    unsigned char* destination;
+  };
+
+  // The jobs of one call. Every call has its own, so callbacks (which can run JavaScript)
+  // may use the reader again while a call is in progress.
+  struct Batch {
+    std::mutex lock;
+    std::condition_variable jobDone;
+    std::deque<Job> completed;
+  };
+
+  void submit(Batch& batch, const Job& job, scheduler::Priority priority);
+  Job wait(Batch& batch);
+
+  // guards the settings below, only held while they are read or changed
+  std::mutex settings;
+  SIZE_T queueDepth;
+  SIZE_T chunkSize;
+  scheduler::Priority readPriority;
+  scheduler::Priority scanPriority;
+
+  // slot buffers come from the pool so they are reused across calls
+  bufferpool& pool;
+};
+#endif
+#pragma once
@@ -0,0 +1,725 @@
+#include <node.h>
+#include <windows.h>
+#include <mmsystem.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "recorder.h"
+#include "memory.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Identifies a recording file and its chunks
+static const char FILE_MAGIC[4] = { 'M', 'J', 'S', 'R' };
+static const char CHUNK_MAGIC[4] = { 'M', 'J', 'S', 'C' };
+static const DWORD FILE_VERSION = 1;
+
+// Above this rate the system timer is switched to 1ms resolution while recording
+static const double FINE_TIMER_RATE = 50;
+
+static const char* typeNames[recorder::TYPE_COUNT] = {
+  "int",
+  "dword",
+  "float",
+  "double",
+  "bool",
+  "ptr"
+};
+
+static const SIZE_T typeSizes[recorder::TYPE_COUNT] = {
+  sizeof(int),
+  sizeof(DWORD),
+  sizeof(float),
+  sizeof(double),
+  sizeof(bool),
+  sizeof(intptr_t)
+};
+
+recorder::recorder() : nextId(1) {}
+
+recorder::~recorder() {
+  while (!sessions.empty()) stop(sessions.begin()->first, nullptr);
+}
+
+static inline int countLeadingZeros(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return 63 - (int)index;
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if (_BitScanReverse(&index, (unsigned long)(value >> 32))) return 31 - (int)index;
+  _BitScanReverse(&index, (unsigned long)value);
+  return 63 - (int)index;
+#else
+  return __builtin_clzll(value);
+#endif
+}
+
+static inline int countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return (int)index;
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if (_BitScanForward(&index, (unsigned long)value)) return (int)index;
+  _BitScanForward(&index, (unsigned long)(value >> 32));
+  return (int)index + 32;
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+
+/* Appends values of up to 64 bits, most significant bit first */
+class bitwriter {
+
+public:
+  bitwriter() : buffer(0), used(0) {}
+
+  std::vector<unsigned char> bytes;
+
+  void write(uint64_t value, int count) {
+    if (count > 32) {
+      write(value >> 32, count - 32);
+      value &= 0xFFFFFFFFULL;
+      count = 32;
+    }
+
+    buffer = buffer << count | (value & ((1ULL << count) - 1));
+    used += count;
+
+    while (used >= 8) {
+      used -= 8;
+      bytes.push_back((unsigned char)(buffer >> used));
+    }
+
+    buffer &= (1ULL << used) - 1;
+  }
+
+  // pads the last byte with zeros
+  void finish() {
+    if (used > 0) bytes.push_back((unsigned char)(buffer << (8 - used)));
+    buffer = 0;
+    used = 0;
+  }
+
+  void clear() {
+    bytes.clear();
+    buffer = 0;
+    used = 0;
+  }
+
+private:
+  uint64_t buffer;
+  int used;
+};
+
+class bitreader {
+
+public:
+  bitreader(const unsigned char* data, SIZE_T size) : data(data), size(size), position(0) {}
+
+  bool read(int count, uint64_t* value) {
+    if (position + count > size * 8) return false;
+
+    uint64_t result = 0;
+
+    while (count > 0) {
+      int available = 8 - (int)(position & 7);
+      int take = (std::min)(available, count);
+      unsigned int bits = (data[position >> 3] >> (available - take)) & ((1u << take) - 1);
+
+      result = result << take | bits;
+      position += take;
+      count -= take;
+    }
+
+    *value = result;
+    return true;
+  }
+
+private:
+  const unsigned char* data;
+  SIZE_T size;
+  SIZE_T position;
+};
+
+/* Compressed samples of one chunk. The first sample is stored as is, every later timestamp as the
+ * difference between its delta and the previous delta (0 at a steady rate), and every value as the XOR
+ * with the previous value of its field: 1 bit if it didn't change, otherwise only the bits between the
+ * leading and trailing zeros of the XOR, reusing the previous field's window if they fit in it. */
+struct encoder {
+  bitwriter bits;
+  DWORD samples;
+  LONGLONG firstTime;
+  LONGLONG lastTime;
+  LONGLONG lastDelta;
+  std::vector<uint64_t> last;
+  // the window of meaningful bits per field, leading is -1 until the field has one
+  std::vector<int> leading;
+  std::vector<int> trailing;
+
+  encoder(SIZE_T fieldCount) : samples(0), firstTime(0), lastTime(0), lastDelta(0), last(fieldCount), leading(fieldCount), trailing(fieldCount) {}
+
+  void add(LONGLONG time, const std::vector<uint64_t>& values) {
+    if (samples == 0) {
+      firstTime = time;
+      lastDelta = 0;
+
+      for (std::vector<uint64_t>::size_type i = 0; i != values.size(); i++) {
+        bits.write(values[i], 64);
+        leading[i] = -1;
+      }
+    } else {
+      LONGLONG delta = time - lastTime;
+      writeTime(delta - lastDelta);
+      lastDelta = delta;
+
+      for (std::vector<uint64_t>::size_type i = 0; i != values.size(); i++) writeValue(i, values[i]);
+    }
+
+    lastTime = time;
+    last = values;
+    samples++;
+  }
+
+  void writeTime(LONGLONG deltaOfDelta) {
+    if (deltaOfDelta == 0) {
+      bits.write(0, 1);
+    } else if (deltaOfDelta >= -63 && deltaOfDelta <= 64) {
+      bits.write(0x2, 2);
+      bits.write((uint64_t)(deltaOfDelta + 63), 7);
+    } else if (deltaOfDelta >= -255 && deltaOfDelta <= 256) {
+      bits.write(0x6, 3);
+      bits.write((uint64_t)(deltaOfDelta + 255), 9);
+    } else if (deltaOfDelta >= -2047 && deltaOfDelta <= 2048) {
+      bits.write(0xE, 4);
+      bits.write((uint64_t)(deltaOfDelta + 2047), 12);
+    } else if (deltaOfDelta >= INT_MIN && deltaOfDelta <= INT_MAX) {
+      bits.write(0x1E, 5);
+      bits.write((uint64_t)(uint32_t)(int32_t)deltaOfDelta, 32);
+    } else {
+      bits.write(0x1F, 5);
+      bits.write((uint64_t)deltaOfDelta, 64);
+    }
+  }
+
+  void writeValue(SIZE_T field, uint64_t value) {
+    uint64_t difference = value ^ last[field];
+
+    if (difference == 0) {
+      bits.write(0, 1);
+      return;
+    }
+
+    // the leading zero count is stored in 5 bits
+    int leadingZeros = (std::min)(countLeadingZeros(difference), 31);
+    int trailingZeros = countTrailingZeros(difference);
+
+    if (leading[field] >= 0 && leadingZeros >= leading[field] && trailingZeros >= trailing[field]) {
+      bits.write(0x2, 2);
+      bits.write(difference >> trailing[field], 64 - leading[field] - trailing[field]);
+      return;
+    }
+
+    // 64 meaningful bits are stored as 0
+    int meaningful = 64 - leadingZeros - trailingZeros;
+    bits.write(0x3, 2);
+    bits.write((uint64_t)leadingZeros, 5);
+    bits.write((uint64_t)(meaningful & 63), 6);
+    bits.write(difference >> trailingZeros, meaningful);
+
+    leading[field] = leadingZeros;
+    trailing[field] = trailingZeros;
+  }
+
+  void reset() {
+    bits.clear();
+    samples = 0;
+  }
+};
+
+static double toValue(const unsigned char* data, recorder::Type type) {
+  switch (type) {
+    case recorder::TYPE_INT: { int value; memcpy(&value, data, sizeof(value)); return value; }
+    case recorder::TYPE_DWORD: { DWORD value; memcpy(&value, data, sizeof(value)); return value; }
+    case recorder::TYPE_FLOAT: { float value; memcpy(&value, data, sizeof(value)); return value; }
+    case recorder::TYPE_DOUBLE: { double value; memcpy(&value, data, sizeof(value)); return value; }
+    case recorder::TYPE_BOOL: return data[0] != 0 ? 1 : 0;
+    case recorder::TYPE_PTR: { intptr_t value; memcpy(&value, data, sizeof(value)); return (double)value; }
+    default: return std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+/* Writes the samples of a chunk and flushes them, so the file is readable up to this chunk if the process dies */
+static bool writeChunk(FILE* file, encoder& chunk, SIZE_T* bytesWritten) {
+  chunk.bits.finish();
+
+  DWORD byteLength = (DWORD)chunk.bits.bytes.size();
+
+  bool success = fwrite(CHUNK_MAGIC, sizeof(CHUNK_MAGIC), 1, file) == 1
+    && fwrite(&chunk.samples, sizeof(chunk.samples), 1, file) == 1
+    && fwrite(&byteLength, sizeof(byteLength), 1, file) == 1
+    && fwrite(&chunk.firstTime, sizeof(chunk.firstTime), 1, file) == 1
+    && fwrite(&chunk.lastTime, sizeof(chunk.lastTime), 1, file) == 1
+    && (byteLength == 0 || fwrite(&chunk.bits.bytes[0], byteLength, 1, file) == 1)
+    && fflush(file) == 0;
+
+  *bytesWritten = sizeof(CHUNK_MAGIC) + sizeof(chunk.samples) + sizeof(byteLength) + sizeof(chunk.firstTime) + sizeof(chunk.lastTime) + byteLength;
+  chunk.reset();
+
+  return success;
+}
+
+/* Opens the recording file, writes its header and starts sampling on a new thread. Returns the id of the recording. */
+int recorder::start(HANDLE handle, const std::vector<Field>& fields, const Options& options, char** errorMessage) {
+  if (fields.empty()) {
+    *errorMessage = "at least one field is required";
+    return 0;
+  }
+
+  if (!(options.rateHz > 0 && options.rateHz <= 1000)) {
+    *errorMessage = "rateHz must be more than 0 and at most 1000";
+    return 0;
+  }
+
+  if (!(options.chunkSamples >= 1 && options.chunkSamples <= 0xFFFFFFFF)) {
+    *errorMessage = "chunkSamples must be at least 1 and at most 4294967295";
+    return 0;
+  }
+
+  if (!(options.chunkInterval >= 0)) {
+    *errorMessage = "chunkInterval must be at least 0";
+    return 0;
+  }
+
+  std::unique_ptr<Session> session(new Session());
+  session->fields = fields;
+  session->options = options;
+  session->stopping = false;
+  session->stats = Stats();
+  session->stats.running = true;
+  session->stats.error = "";
+
+  // fields are sampled with as few reads as possible, fields that are close together share a read
+  std::vector<SIZE_T> order(fields.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](SIZE_T a, SIZE_T b) { return fields[a].address < fields[b].address; });
+
+  session->fieldRead.resize(fields.size());
+  session->fieldOffset.resize(fields.size());
+
+  for (std::vector<SIZE_T>::size_type i = 0; i != order.size(); i++) {
+    const Field& field = fields[order[i]];
+    SIZE_T size = typeSizes[field.type];
+
+    if (!session->reads.empty()) {
+      Read& last = session->reads.back();
+      uintptr_t end = last.address + last.size;
+
+      if (field.address <= end + MERGE_GAP && field.address + size - last.address <= MAX_READ_SIZE) {
+        last.size = (std::max)(end, field.address + size) - last.address;
+      } else {
+        Read read = { field.address, size };
+        session->reads.push_back(read);
+      }
+    } else {
+      Read read = { field.address, size };
+      session->reads.push_back(read);
+    }
+
+    session->fieldRead[order[i]] = session->reads.size() - 1;
+    session->fieldOffset[order[i]] = field.address - session->reads.back().address;
+  }
+
+  if (!DuplicateHandle(GetCurrentProcess(), handle, GetCurrentProcess(), &session->handle, 0, FALSE, DUPLICATE_SAME_ACCESS)) {
+    *errorMessage = "unable to duplicate the process handle";
+    return 0;
+  }
+
+  session->file = fopen(options.path.c_str(), "wb");
+
+  if (session->file == nullptr) {
+    CloseHandle(session->handle);
+    *errorMessage = "unable to open the recording file for writing";
+    return 0;
+  }
+
+  DWORD fieldCount = (DWORD)fields.size();
+
+  bool success = fwrite(FILE_MAGIC, sizeof(FILE_MAGIC), 1, session->file) == 1
+    && fwrite(&FILE_VERSION, sizeof(FILE_VERSION), 1, session->file) == 1
+    && fwrite(&options.rateHz, sizeof(options.rateHz), 1, session->file) == 1
+    && fwrite(&fieldCount, sizeof(fieldCount), 1, session->file) == 1;
+
+  for (std::vector<Field>::size_type i = 0; success && i != fields.size(); i++) {
+    DWORD nameLength = (DWORD)fields[i].name.size();
+    DWORD type = fields[i].type;
+    DWORD64 address = fields[i].address;
+
+    success = fwrite(&nameLength, sizeof(nameLength), 1, session->file) == 1
+      && (nameLength == 0 || fwrite(fields[i].name.c_str(), nameLength, 1, session->file) == 1)
+      && fwrite(&type, sizeof(type), 1, session->file) == 1
+      && fwrite(&address, sizeof(address), 1, session->file) == 1;
+  }
+
+  if (!success || fflush(session->file) != 0) {
+    fclose(session->file);
+    CloseHandle(session->handle);
+    *errorMessage = "unable to write the recording file";
+    return 0;
+  }
+
+  int id = nextId++;
+  Session* started = session.get();
+  sessions[id] = std::move(session);
+  started->thread = std::thread(run, started);
+
+  return id;
+}
+
+/* The sampling thread: waits for the next tick (or for stop), reads every field, and appends a chunk once it is full */
+void recorder::run(Session* session) {
+  typedef std::chrono::steady_clock clock;
+
+  const Options& options = session->options;
+
+  // the period is a whole number of microseconds, so a steady recording has a delta of delta of exactly 0
+  LONGLONG periodMicros = (std::max)((LONGLONG)(1000000.0 / options.rateHz + 0.5), (LONGLONG)1);
+  std::chrono::microseconds period(periodMicros);
+
+  // timestamps are microseconds since the Unix epoch of the tick a sample was scheduled for,
+  // not of when the thread woke up, so scheduling jitter doesn't cost bits
+  LONGLONG startTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  clock::time_point start = clock::now();
+  clock::time_point next = start;
+  unsigned long long tick = 0;
+
+  std::vector<std::vector<unsigned char>> buffers(session->reads.size());
+  for (std::vector<Read>::size_type i = 0; i != session->reads.size(); i++) buffers[i].resize(session->reads[i].size);
+
+  std::vector<bool> readOk(session->reads.size());
+  std::vector<uint64_t> values(session->fields.size());
+  encoder chunk(session->fields.size());
+  const char* error = "";
+
+  // Windows timers tick every 15.6ms by default, too coarse for high rates
+  bool fineTimer = options.rateHz > FINE_TIMER_RATE && timeBeginPeriod(1) == TIMERR_NOERROR;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> guard(session->lock);
+      session->wake.wait_until(guard, next, [&]() { return session->stopping; });
+      if (session->stopping) break;
+    }
+
+    LONGLONG time = startTime + (LONGLONG)tick * periodMicros;
+    unsigned long long failedReads = 0;
+
+    for (std::vector<Read>::size_type i = 0; i != session->reads.size(); i++) {
+      readOk[i] = memory::readBuffer(session->handle, session->reads[i].address, &buffers[i][0], session->reads[i].size);
+      if (!readOk[i]) failedReads++;
+    }
+
+    for (std::vector<Field>::size_type i = 0; i != session->fields.size(); i++) {
+      SIZE_T read = session->fieldRead[i];
+      double value = readOk[read] ? toValue(&buffers[read][session->fieldOffset[i]], session->fields[i].type) : std::numeric_limits<double>::quiet_NaN();
+      memcpy(&values[i], &value, sizeof(value));
+    }
+
+    chunk.add(time, values);
+
+    // ticks that were missed are skipped rather than sampled in a burst
+    unsigned long long missedSamples = 0;
+    clock::time_point now = clock::now();
+    next = start + period * (LONGLONG)++tick;
+
+    if (next <= now) {
+      missedSamples = (unsigned long long)((now - next) / period) + 1;
+      tick += missedSamples;
+      next = start + period * (LONGLONG)tick;
+    }
+
+    SIZE_T bytesWritten = 0;
+    bool full = chunk.samples >= options.chunkSamples || (double)(time - chunk.firstTime) >= options.chunkInterval * 1000;
+
+    if (full && !writeChunk(session->file, chunk, &bytesWritten)) error = "unable to write the recording file";
+
+    {
+      std::lock_guard<std::mutex> guard(session->lock);
+      session->stats.samples++;
+      session->stats.missedSamples += missedSamples;
+      session->stats.failedReads += failedReads;
+
+      if (full) {
+        session->stats.chunks++;
+        session->stats.bytesWritten += bytesWritten;
+      }
+
+      if (strcmp(error, "")) {
+        session->stats.error = error;
+        break;
+      }
+    }
+  }
+
+  SIZE_T bytesWritten = 0;
+  bool written = chunk.samples > 0 && !strcmp(error, "");
+
+  if (written && !writeChunk(session->file, chunk, &bytesWritten)) error = "unable to write the recording file";
+  if (fclose(session->file) != 0 && !strcmp(error, "")) error = "unable to write the recording file";
+  CloseHandle(session->handle);
+
+  if (fineTimer) timeEndPeriod(1);
+
+  std::lock_guard<std::mutex> guard(session->lock);
+  if (written) {
+    session->stats.chunks++;
+    session->stats.bytesWritten += bytesWritten;
+  }
+  session->stats.error = error;
+  session->stats.running = false;
+}
+
+/* Stops a recording and waits for its last chunk to be written */
+bool recorder::stop(int id, Stats* stats) {
+  std::map<int, std::unique_ptr<Session>>::iterator found = sessions.find(id);
+  if (found == sessions.end()) return false;
+
+  Session* session = found->second.get();
+
+  {
+    std::lock_guard<std::mutex> guard(session->lock);
+    session->stopping = true;
+  }
+
+  session->wake.notify_all();
+  session->thread.join();
+
+  if (stats != nullptr) *stats = session->stats;
+
+  sessions.erase(found);
+  return true;
+}
+
+bool recorder::getStats(int id, Stats* stats) {
+  std::map<int, std::unique_ptr<Session>>::iterator found = sessions.find(id);
+  if (found == sessions.end()) return false;
+
+  std::lock_guard<std::mutex> guard(found->second->lock);
+  *stats = found->second->stats;
+  return true;
+}
+
+/* Decodes one chunk, keeping the samples between from and to */
+static bool decodeChunk(const std::vector<unsigned char>& data, DWORD samples, LONGLONG firstTime, double from, double to, recorder::Recording& recording) {
+  SIZE_T fieldCount = recording.fields.size();
+  bitreader bits(data.empty() ? nullptr : &data[0], data.size());
+
+  std::vector<uint64_t> last(fieldCount);
+  std::vector<int> leading(fieldCount, 0);
+  std::vector<int> trailing(fieldCount, 0);
+  LONGLONG time = firstTime;
+  LONGLONG delta = 0;
+  uint64_t value;
+
+  for (DWORD sample = 0; sample < samples; sample++) {
+    if (sample > 0) {
+      // the prefix of the delta of delta: 0, 10, 110, 1110, 11110 or 11111
+      int ones = 0;
+      while (ones < 5) {
+        if (!bits.read(1, &value)) return false;
+        if (value == 0) break;
+        ones++;
+      }
+
+      static const int valueBits[6] = { 0, 7, 9, 12, 32, 64 };
+      static const LONGLONG bias[6] = { 0, 63, 255, 2047, 0, 0 };
+      LONGLONG deltaOfDelta = 0;
+
+      if (ones > 0) {
+        if (!bits.read(valueBits[ones], &value)) return false;
+
+        if (ones == 4) deltaOfDelta = (int32_t)(uint32_t)value;
+        else deltaOfDelta = (LONGLONG)value - bias[ones];
+      }
+
+      delta += deltaOfDelta;
+      time += delta;
+    }
+
+    for (SIZE_T field = 0; field < fieldCount; field++) {
+      if (sample == 0) {
+        if (!bits.read(64, &last[field])) return false;
+        continue;
+      }
+
+      if (!bits.read(1, &value)) return false;
+      if (value == 0) continue;
+
+      if (!bits.read(1, &value)) return false;
+
+      if (value == 1) {
+        uint64_t leadingZeros;
+        uint64_t meaningful;
+        if (!bits.read(5, &leadingZeros) || !bits.read(6, &meaningful)) return false;
+        if (meaningful == 0) meaningful = 64;
+        if (leadingZeros + meaningful > 64) return false;
+
+        leading[field] = (int)leadingZeros;
+        trailing[field] = (int)(64 - leadingZeros - meaningful);
+      }
+
+      if (!bits.read(64 - leading[field] - trailing[field], &value)) return false;
+      last[field] ^= value << trailing[field];
+    }
+
+    double milliseconds = (double)time / 1000;
+    if (milliseconds < from || milliseconds > to) continue;
+
+    recording.times.push_back(milliseconds);
+
+    for (SIZE_T field = 0; field < fieldCount; field++) {
+      double fieldValue;
+      memcpy(&fieldValue, &last[field], sizeof(fieldValue));
+      recording.values[field].push_back(fieldValue);
+    }
+  }
+
+  return true;
+}
+
+/* Reads the header, then only decodes the chunks that overlap the time range (the others are skipped using
+ * the times in their headers). A chunk that was cut off, or whose header doesn't fit its length, ends the recording. */
+bool recorder::read(const char* path, double from, double to, Recording& recording, char** errorMessage) {
+  FILE* file = fopen(path, "rb");
+
+  if (file == nullptr) {
+    *errorMessage = "unable to open the recording file for reading";
+    return false;
+  }
+
+  char magic[4];
+  DWORD version;
+  DWORD fieldCount;
+
+  bool success = fread(magic, sizeof(magic), 1, file) == 1
+    && fread(&version, sizeof(version), 1, file) == 1
+    && fread(&recording.rateHz, sizeof(recording.rateHz), 1, file) == 1
+    && fread(&fieldCount, sizeof(fieldCount), 1, file) == 1
+    && !memcmp(magic, FILE_MAGIC, sizeof(magic))
+    && version == FILE_VERSION
+    && fieldCount <= 0x10000;
+
+  for (DWORD i = 0; success && i < fieldCount; i++) {
+    DWORD nameLength;
+    DWORD type;
+    DWORD64 address;
+    Field field;
+
+    success = fread(&nameLength, sizeof(nameLength), 1, file) == 1 && nameLength <= 0x1000;
+
+    if (success) {
+      field.name.resize(nameLength);
+      success = (nameLength == 0 || fread(&field.name[0], nameLength, 1, file) == 1)
+        && fread(&type, sizeof(type), 1, file) == 1
+        && fread(&address, sizeof(address), 1, file) == 1
+        && type < TYPE_COUNT;
+    }
+
+    if (success) {
+      field.type = (Type)type;
+      field.address = (uintptr_t)address;
+      recording.fields.push_back(field);
+    }
+  }
+
+  // chunk lengths are checked against the size of the file before anything is allocated for them
+  LONGLONG position = success ? _ftelli64(file) : -1;
+  LONGLONG fileSize = position >= 0 && _fseeki64(file, 0, SEEK_END) == 0 ? _ftelli64(file) : -1;
+
+  success = success && fileSize >= position && _fseeki64(file, position, SEEK_SET) == 0;
+
+  if (!success) {
+    fclose(file);
+    *errorMessage = "invalid recording file";
+    return false;
+  }
+
+  recording.values.resize(fieldCount);
+  std::vector<unsigned char> data;
+
+  while (true) {
+    DWORD samples;
+    DWORD byteLength;
+    LONGLONG firstTime;
+    LONGLONG lastTime;
+
+    if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, CHUNK_MAGIC, sizeof(magic))
+      || fread(&samples, sizeof(samples), 1, file) != 1
+      || fread(&byteLength, sizeof(byteLength), 1, file) != 1
+      || fread(&firstTime, sizeof(firstTime), 1, file) != 1
+      || fread(&lastTime, sizeof(lastTime), 1, file) != 1) {
+      break;
+    }
+
+    // the first sample takes 64 bits per field, every later one at least one bit for its time and one per field.
+    // A chunk that is longer than the rest of the file, or has more samples than its bits can hold, is damaged.
+    position = _ftelli64(file);
+    DWORD64 bits = (DWORD64)byteLength * 8;
+    DWORD64 firstBits = (DWORD64)fieldCount * 64;
+
+    if (position < 0 || byteLength > fileSize - position) break;
+    if (samples > 0 && (bits < firstBits || samples - 1 > (bits - firstBits) / (fieldCount + 1))) break;
+
+    // chunks are in time order
+    if ((double)firstTime / 1000 > to) break;
+
+    if ((double)lastTime / 1000 < from) {
+      if (_fseeki64(file, byteLength, SEEK_CUR) != 0) break;
+      continue;
+    }
+
+    data.resize(byteLength);
+    if (byteLength > 0 && fread(&data[0], byteLength, 1, file) != 1) break;
+
+    if (!decodeChunk(data, samples, firstTime, from, to, recording)) {
+      fclose(file);
+      *errorMessage = "invalid recording file";
+      return false;
+    }
+  }
+
+  fclose(file);
+  return true;
+}
+
+bool recorder::parseType(const char* name, Type* type) {
+  for (int i = 0; i < TYPE_COUNT; i++) {
+    if (!strcmp(name, typeNames[i])) {
+      *type = (Type)i;
+      return true;
+    }
+  }
+
+  // the other names readMemory accepts for these types
+  if (!strcmp(name, "long")) *type = TYPE_INT;
+  else if (!strcmp(name, "boolean")) *type = TYPE_BOOL;
+  else if (!strcmp(name, "pointer")) *type = TYPE_PTR;
+  else return false;
+
+  return true;
+}
+
+const char* recorder::getTypeName(Type type) {
+  return typeNames[type];
+}
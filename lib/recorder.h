@@ -0,0 +1,117 @@
+#pragma once
+#ifndef RECORDER_H
+#define RECORDER_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Samples values of a process at a fixed rate on a dedicated thread and writes them to a file.
+ * Samples are compressed like Gorilla (the Facebook time series store): timestamps with delta-of-delta
+ * encoding and values by XORing them with the previous value of the same field, so values that change
+ * slowly take a few bits per sample. The file is a header followed by chunks that can be decoded on their
+ * own, a chunk is only appended once it is complete, so a file that was cut off is readable up to its last chunk. */
+class recorder {
+
+public:
+  recorder();
+  ~recorder();
+
+  enum Type {
+    TYPE_INT,
+    TYPE_DWORD,
+    TYPE_FLOAT,
+    TYPE_DOUBLE,
+    TYPE_BOOL,
+    TYPE_PTR,
+    TYPE_COUNT
+  };
+
+  struct Field {
+    std::string name;
+    uintptr_t address;
+    Type type;
+  };
+
+  struct Options {
+    double rateHz;
+    std::string path;
+    // a chunk is written once it has this many samples, or spans this many milliseconds
+    double chunkSamples;
+    double chunkInterval;
+  };
+
+  struct Stats {
+    bool running;
+    unsigned long long samples;
+    unsigned long long chunks;
+    unsigned long long bytesWritten;
+    // ticks skipped because sampling fell behind the rate
+    unsigned long long missedSamples;
+    // reads that failed, the fields they cover are recorded as NaN
+    unsigned long long failedReads;
+    // set if the recording stopped on its own
+    const char* error;
+  };
+
+  // Decoded samples, times are milliseconds since the Unix epoch and values[field][sample]
+  struct Recording {
+    double rateHz;
+    std::vector<Field> fields;
+    std::vector<double> times;
+    std::vector<std::vector<double>> values;
+  };
+
+  // Fields that are at most this many bytes apart are sampled with the same read
+  static const SIZE_T MERGE_GAP = 0x1000;
+  static const SIZE_T MAX_READ_SIZE = 64 * 1024;
+
+  int start(HANDLE handle, const std::vector<Field>& fields, const Options& options, char** errorMessage);
+  bool stop(int id, Stats* stats);
+  bool getStats(int id, Stats* stats);
+
+  // decodes the samples taken between from and to (milliseconds since the Unix epoch, inclusive)
+  static bool read(const char* path, double from, double to, Recording& recording, char** errorMessage);
+
+  static bool parseType(const char* name, Type* type);
+  static const char* getTypeName(Type type);
+
+private:
+  struct Read {
+    uintptr_t address;
+    SIZE_T size;
+  };
+
+  struct Session {
+    // a duplicate of the caller's handle, so closing the process doesn't pull it from under the sampling thread
+    HANDLE handle;
+    std::vector<Field> fields;
+    std::vector<Read> reads;
+    // the read that covers each field, and the field's offset in it
+    std::vector<SIZE_T> fieldRead;
+    std::vector<SIZE_T> fieldOffset;
+    Options options;
+    FILE* file;
+    std::thread thread;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping;
+    Stats stats;
+  };
+
+  static void run(Session* session);
+
+  std::map<int, std::unique_ptr<Session>> sessions;
+  int nextId;
+};
+#endif
+#pragma once
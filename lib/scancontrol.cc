@@ -0,0 +1,79 @@
+#include <node.h>
+#include <windows.h>
+#include "scancontrol.h"
+
+scancontrol::scancontrol() : cancelFlag(nullptr), hasDeadline(false), timeout(0), progressInterval(0), bytesScanned(0), bytesTotal(0), stopped(false) {}
+scancontrol::~scancontrol() {}
+
+void scancontrol::setCancelFlag(volatile int32_t* flag) {
+  cancelFlag = flag;
+}
+
+void scancontrol::setTimeout(double milliseconds) {
+  hasDeadline = true;
+  timeout = milliseconds;
+}
+
+void scancontrol::setProgressCallback(const ProgressCallback& callback, double intervalMilliseconds) {
+  progressCallback = callback;
+  progressInterval = intervalMilliseconds;
+}
+
+/* Called once the size of the scan is known, starts the clock for the deadline */
+void scancontrol::begin(SIZE_T bytesTotal) {
+  this->bytesTotal = bytesTotal;
+  bytesScanned = 0;
+  stopped = false;
+  started = lastReport = clock::now();
+  deadline = started + std::chrono::microseconds((long long)(timeout * 1000));
+}
+
+/* Adds to the size of a scan that turned out to be larger, without restarting the clock */
+void scancontrol::extend(SIZE_T bytes) {
+  bytesTotal += bytes;
+}
+
+/* Safe to call from any thread */
+void scancontrol::advance(SIZE_T bytes) {
+  bytesScanned += bytes;
+}
+
+/* Safe to call from any thread */
+bool scancontrol::shouldStop() {
+  if (stopped) return true;
+
+  if ((cancelFlag != nullptr && *cancelFlag != 0) || (hasDeadline && clock::now() >= deadline)) {
+    stopped = true;
+  }
+
+  return stopped;
+}
+
+/* True if the scan was cancelled or ran out of time, i.e. the results are partial */
+bool scancontrol::wasStopped() {
+  return stopped;
+}
+
+scancontrol::Progress scancontrol::getProgress() {
+  Progress progress;
+  progress.bytesScanned = bytesScanned;
+  progress.bytesTotal = bytesTotal;
+  progress.elapsed = std::chrono::duration<double, std::milli>(clock::now() - started).count();
+
+  // estimate the time left from the average rate so far
+  progress.eta = progress.bytesScanned == 0 ? -1
+    : progress.elapsed * (double)(progress.bytesTotal - (progress.bytesTotal < progress.bytesScanned ? progress.bytesTotal : progress.bytesScanned)) / progress.bytesScanned;
+
+  return progress;
+}
+
+/* Calls the progress callback at most once per interval, must be called from the thread that owns the callback */
+void scancontrol::reportProgress(bool force) {
+  if (!progressCallback) return;
+
+  clock::time_point now = clock::now();
+  if (!force && std::chrono::duration<double, std::milli>(now - lastReport).count() < progressInterval) return;
+
+  lastReport = now;
+  progressCallback(getProgress());
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef SCANCONTROL_H
+#define SCANCONTROL_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+/* Cancellation, deadline and progress reporting for long running scans.
+ * Scans call advance() after every chunk and stop as soon as shouldStop() returns true.
+ * The cancel flag is an int32 that another thread can set while the scan runs (a SharedArrayBuffer). */
+class scancontrol {
+
+public:
+  scancontrol();
+  ~scancontrol();
+
+  struct Progress {
+    SIZE_T bytesScanned;
+    SIZE_T bytesTotal;
+    double elapsed;
+    double eta;
+  };
+
+  typedef std::function<void(const Progress&)> ProgressCallback;
+
+  void setCancelFlag(volatile int32_t* flag);
+  void setTimeout(double milliseconds);
+  void setProgressCallback(const ProgressCallback& callback, double intervalMilliseconds);
+
+  void begin(SIZE_T bytesTotal);
+  void extend(SIZE_T bytes);
+  void advance(SIZE_T bytes);
+  bool shouldStop();
+  bool wasStopped();
+  void reportProgress(bool force);
+  Progress getProgress();
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  volatile int32_t* cancelFlag;
+  bool hasDeadline;
+  double timeout;
+  clock::time_point started;
+  clock::time_point deadline;
+  clock::time_point lastReport;
+
+  ProgressCallback progressCallback;
+  double progressInterval;
+
+  std::atomic<SIZE_T> bytesScanned;
+  SIZE_T bytesTotal;
+  std::atomic<bool> stopped;
+};
+#endif
+#pragma once
@@ -0,0 +1,182 @@
+#include <node.h>
+#include <windows.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "scheduler.h"
+
+static const char* priorityNames[scheduler::PRIORITY_COUNT] = {
+  "critical",
+  "normal",
+  "background"
+};
+
+scheduler::scheduler() : threadCount(0), retiring(0) {
+  for (int i = 0; i < PRIORITY_COUNT; i++) {
+    classes[i].queued = classes[i].peakQueued = classes[i].running = 0;
+    classes[i].completed = 0;
+    classes[i].nextWait = 0;
+  }
+
+  setThreadCount((std::max)(4U, std::thread::hardware_concurrency()));
+}
+
+scheduler::~scheduler() {}
+
+/* The scheduler lives as long as the process. It is never destroyed: workers are detached and
+ * joining threads from a static destructor while the DLL is being unloaded can deadlock. */
+scheduler& scheduler::get() {
+  static scheduler* instance = new scheduler();
+  return *instance;
+}
+
+void scheduler::submit(HANDLE handle, Priority priority, const Task& task) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    Class& queue = classes[priority];
+    std::deque<Entry>& entries = queue.queues[handle];
+
+    if (entries.empty()) queue.turns.push_back(handle);
+
+    Entry entry = { task, clock::now() };
+    entries.push_back(entry);
+    queue.peakQueued = (std::max)(queue.peakQueued, ++queue.queued);
+  }
+
+  taskReady.notify_one();
+}
+
+/* Takes the next task of the most urgent class that has one, giving handles turns within the class.
+ * Must be called with the lock held. */
+bool scheduler::next(Entry& entry, Priority* priority) {
+  for (int i = 0; i < PRIORITY_COUNT; i++) {
+    Class& queue = classes[i];
+    if (queue.turns.empty()) continue;
+
+    HANDLE handle = queue.turns.front();
+    queue.turns.pop_front();
+
+    std::map<HANDLE, std::deque<Entry>>::iterator entries = queue.queues.find(handle);
+    entry = entries->second.front();
+    entries->second.pop_front();
+
+    if (entries->second.empty()) {
+      queue.queues.erase(entries);
+    } else {
+      queue.turns.push_back(handle);
+    }
+
+    queue.queued--;
+    queue.running++;
+
+    double wait = std::chrono::duration<double, std::milli>(clock::now() - entry.queued).count();
+    if (queue.waits.size() < WAIT_SAMPLES) {
+      queue.waits.push_back(wait);
+    } else {
+      queue.waits[queue.nextWait] = wait;
+      queue.nextWait = (queue.nextWait + 1) % WAIT_SAMPLES;
+    }
+
+    *priority = (Priority)i;
+    return true;
+  }
+
+  return false;
+}
+
+void scheduler::work() {
+  std::unique_lock<std::mutex> guard(lock);
+
+  while (true) {
+    Entry entry;
+    Priority priority;
+
+    taskReady.wait(guard, [&] { return retiring > 0 || next(entry, &priority); });
+
+    if (!entry.task) {
+      retiring--;
+      return;
+    }
+
+    guard.unlock();
+    entry.task();
+    guard.lock();
+
+    classes[priority].running--;
+    classes[priority].completed++;
+  }
+}
+
+/* Adds workers straight away, extra workers exit once they finish their current task */
+void scheduler::setThreadCount(SIZE_T threadCount) {
+  threadCount = (std::max)((SIZE_T)1, threadCount);
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  for (; this->threadCount < threadCount; this->threadCount++) {
+    if (retiring > 0) {
+      retiring--;
+    } else {
+      std::thread(&scheduler::work, this).detach();
+    }
+  }
+
+  if (this->threadCount > threadCount) {
+    retiring += this->threadCount - threadCount;
+    this->threadCount = threadCount;
+    taskReady.notify_all();
+  }
+}
+
+SIZE_T scheduler::getThreadCount() {
+  std::lock_guard<std::mutex> guard(lock);
+  return threadCount;
+}
+
+SIZE_T scheduler::getHandleCount() {
+  std::lock_guard<std::mutex> guard(lock);
+  SIZE_T count = 0;
+
+  for (int i = 0; i < PRIORITY_COUNT; i++) count += classes[i].queues.size();
+
+  return count;
+}
+
+scheduler::Stats scheduler::getStats(Priority priority) {
+  std::lock_guard<std::mutex> guard(lock);
+  Class& queue = classes[priority];
+
+  Stats stats;
+  stats.queued = queue.queued;
+  stats.peakQueued = queue.peakQueued;
+  stats.running = queue.running;
+  stats.completed = queue.completed;
+  stats.waitAverage = stats.waitP99 = 0;
+
+  if (!queue.waits.empty()) {
+    std::vector<double> waits(queue.waits);
+    std::sort(waits.begin(), waits.end());
+
+    for (std::vector<double>::size_type i = 0; i != waits.size(); i++) stats.waitAverage += waits[i];
+    stats.waitAverage /= waits.size();
+    stats.waitP99 = waits[(waits.size() - 1) * 99 / 100];
+  }
+
+  return stats;
+}
+
+bool scheduler::parsePriority(const char* name, Priority* priority) {
+  for (int i = 0; i < PRIORITY_COUNT; i++) {
+    if (!strcmp(name, priorityNames[i])) {
+      *priority = (Priority)i;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+const char* scheduler::getPriorityName(Priority priority) {
+  return priorityNames[priority];
+}
@@ -0,0 +1,95 @@
+#pragma once
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Worker pool shared by every instance of the addon (the main thread and all workers).
+ * Bulk reads and scans are split into chunk sized tasks, and a free worker always takes a task
+ * from the most urgent priority class, so urgent reads only wait for the chunks already running.
+ * Within a class, handles take turns so one process being scanned doesn't starve the others. */
+class scheduler {
+
+public:
+  enum Priority {
+    // critical: latency sensitive reads, e.g. every frame of an overlay
+    // normal: other bulk reads
+    // background: scans and dumps
+    PRIORITY_CRITICAL,
+    PRIORITY_NORMAL,
+    PRIORITY_BACKGROUND,
+    PRIORITY_COUNT
+  };
+
+  typedef std::function<void()> Task;
+
+  struct Stats {
+    SIZE_T queued;
+    SIZE_T peakQueued;
+    SIZE_T running;
+    unsigned long long completed;
+    // time tasks spent queued, in milliseconds, over the last WAIT_SAMPLES tasks
+    double waitAverage;
+    double waitP99;
+  };
+
+  static const SIZE_T WAIT_SAMPLES = 1024;
+
+  static scheduler& get();
+
+  void submit(HANDLE handle, Priority priority, const Task& task);
+
+  void setThreadCount(SIZE_T threadCount);
+  SIZE_T getThreadCount();
+  SIZE_T getHandleCount();
+  Stats getStats(Priority priority);
+
+  static bool parsePriority(const char* name, Priority* priority);
+  static const char* getPriorityName(Priority priority);
+
+private:
+  scheduler();
+  ~scheduler();
+
+  typedef std::chrono::steady_clock clock;
+
+  struct Entry {
+    Task task;
+    clock::time_point queued;
+  };
+
+  // a queue per handle, and the order in which handles take their turn
+  struct Class {
+    std::map<HANDLE, std::deque<Entry>> queues;
+    std::deque<HANDLE> turns;
+    SIZE_T queued;
+    SIZE_T peakQueued;
+    SIZE_T running;
+    unsigned long long completed;
+    // ring buffer of the last WAIT_SAMPLES wait times
+    std::vector<double> waits;
+    SIZE_T nextWait;
+  };
+
+  void work();
+  bool next(Entry& entry, Priority* priority);
+
+  std::mutex lock;
+  std::condition_variable taskReady;
+  Class classes[PRIORITY_COUNT];
+  SIZE_T threadCount;
+  // workers that should exit after their current task, when the thread count is lowered
+  SIZE_T retiring;
+};
+#endif
+#pragma once
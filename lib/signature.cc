@@ -0,0 +1,319 @@
+#include <node.h>
+#include <windows.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "signature.h"
+
+#define INRANGE(x,a,b) (x >= a && x <= b)
+#define isHex( x ) (INRANGE(x,'0','9') || INRANGE((x&(~0x20)),'A','F'))
+#define getBits( x ) (INRANGE(x,'0','9') ? (x - '0') : ((x&(~0x20)) - 'A' + 0xa))
+#define getByte( x ) (getBits(x[0]) << 4 | getBits(x[1]))
+
+#define SET_BYTE(set, value) (set[(value) >> 3] |= 1 << ((value) & 7))
+#define HAS_BYTE(set, value) ((set[(value) >> 3] >> ((value) & 7)) & 1)
+
+signature::signature() : minSize(0), maxSize(0), firstByte(-1) {}
+signature::~signature() {}
+
+/* Parses one byte item into set: `A9`, `4?`, `?4`, `?` or a range `70-7F` */
+bool signature::parseByte(const char*& pattern, unsigned char* set, char** errorMessage) {
+  if (pattern[0] == '?') {
+    // `?4` is a nibble wildcard, but `?A9` is a wildcard followed by a byte
+    if (isHex(pattern[1]) && !isHex(pattern[2])) {
+      for (int high = 0; high < 16; high++) SET_BYTE(set, high << 4 | getBits(pattern[1]));
+      pattern += 2;
+      return true;
+    }
+
+    // a single `?` is a whole byte, so `??` is two bytes like it has always been
+    memset(set, 0xFF, 32);
+    pattern += 1;
+    return true;
+  }
+
+  if (!isHex(pattern[0])) {
+    *errorMessage = "invalid character in signature";
+    return false;
+  }
+
+  if (pattern[1] == '?') {
+    for (int low = 0; low < 16; low++) SET_BYTE(set, getBits(pattern[0]) << 4 | low);
+    pattern += 2;
+    return true;
+  }
+
+  if (!isHex(pattern[1])) {
+    *errorMessage = "bytes in a signature must be two hex digits";
+    return false;
+  }
+
+  int low = getByte(pattern);
+  int high = low;
+  pattern += 2;
+
+  if (pattern[0] == '-' && isHex(pattern[1]) && isHex(pattern[2])) {
+    high = getByte((pattern + 1));
+    pattern += 3;
+
+    if (high < low) {
+      *errorMessage = "invalid byte range in signature";
+      return false;
+    }
+  }
+
+  for (int value = low; value <= high; value++) SET_BYTE(set, value);
+  return true;
+}
+
+int signature::findCapture(const std::string& name) const {
+  for (std::vector<std::string>::size_type i = 0; i != captureNames.size(); i++) {
+    if (captureNames[i] == name) return (int)i;
+  }
+
+  return -1;
+}
+
+/* Parses `@at(name)`, `@rel32`, `@rel32(name)`, `@rel32(name, 5)` or `@deref(2)` */
+bool signature::parseOperation(const char*& pattern, char** errorMessage) {
+  const char* start = ++pattern;
+  while (isalnum(*pattern)) pattern++;
+  std::string name(start, pattern);
+
+  Operation operation;
+  operation.capture = -1;
+
+  if (name == "at") {
+    operation.type = Operation::OP_AT;
+    operation.value = 0;
+  } else if (name == "rel32") {
+    operation.type = Operation::OP_REL32;
+    operation.value = 4;
+  } else if (name == "deref") {
+    operation.type = Operation::OP_DEREF;
+    operation.value = 1;
+  } else {
+    *errorMessage = "unknown signature operation";
+    return false;
+  }
+
+  if (*pattern == '(') {
+    pattern++;
+
+    for (;;) {
+      while (*pattern == ' ') pattern++;
+
+      if (isdigit(*pattern)) {
+        // counts are decimal like gaps, base 0 would read 010 as octal and 08 as 0 followed by junk
+        char* end;
+        operation.value = (SIZE_T)strtoull(pattern, &end, 10);
+        pattern = end;
+      } else if (isalpha(*pattern) || *pattern == '_') {
+        start = pattern;
+        while (isalnum(*pattern) || *pattern == '_') pattern++;
+
+        operation.capture = findCapture(std::string(start, pattern));
+        if (operation.capture == -1) {
+          *errorMessage = "unknown capture in signature operation";
+          return false;
+        }
+      }
+
+      while (*pattern == ' ') pattern++;
+
+      if (*pattern == ')') break;
+
+      if (*pattern != ',') {
+        *errorMessage = "invalid arguments to signature operation";
+        return false;
+      }
+
+      pattern++;
+    }
+
+    pattern++;
+  }
+
+  if (operation.type == Operation::OP_AT && operation.capture == -1) {
+    *errorMessage = "@at requires a capture";
+    return false;
+  }
+
+  operations.push_back(operation);
+  return true;
+}
+
+bool signature::compile(const char* pattern, char** errorMessage) {
+  elements.clear();
+  captureElements.clear();
+  captureNames.clear();
+  operations.clear();
+  minSize = maxSize = 0;
+
+  for (;;) {
+    while (*pattern == ' ') pattern++;
+    if (!*pattern) break;
+
+    // operations are applied to the match, so they come after the whole pattern
+    if (*pattern == '@') {
+      if (!parseOperation(pattern, errorMessage)) return false;
+      continue;
+    }
+
+    if (!operations.empty()) {
+      *errorMessage = "signature operations must be at the end of the signature";
+      return false;
+    }
+
+    Element element = {};
+
+    if (*pattern == '<') {
+      const char* end = strchr(pattern, '>');
+      std::string name = end != nullptr ? std::string(pattern + 1, end) : "";
+
+      if (name.empty() || findCapture(name) != -1) {
+        *errorMessage = "captures must have a unique name, e.g. <name>";
+        return false;
+      }
+
+      captureNames.push_back(name);
+      captureElements.push_back(elements.size());
+      pattern = end + 1;
+      continue;
+    }
+
+    if (*pattern == '[') {
+      // strtoull would also accept spaces and a sign, the bounds have to start with a digit
+      char* end = const_cast<char*>(pattern + 1);
+      element.gap = true;
+
+      if (isdigit(*end)) {
+        element.minGap = element.maxGap = (SIZE_T)strtoull(end, &end, 10);
+        if (*end == '-' && isdigit(end[1])) element.maxGap = (SIZE_T)strtoull(end + 1, &end, 10);
+      }
+
+      if (*end != ']' || end == pattern + 1 || element.maxGap < element.minGap) {
+        *errorMessage = "gaps must be of the form [n] or [min-max]";
+        return false;
+      }
+
+      if (element.maxGap > MAX_GAP) {
+        *errorMessage = "gaps can be at most 4096 bytes";
+        return false;
+      }
+
+      pattern = end + 1;
+    } else if (*pattern == '(') {
+      pattern++;
+
+      for (;;) {
+        while (*pattern == ' ') pattern++;
+        if (!parseByte(pattern, element.set, errorMessage)) return false;
+        while (*pattern == ' ') pattern++;
+
+        if (*pattern == ')') break;
+
+        if (*pattern != '|') {
+          *errorMessage = "alternatives must be separated by | and end with )";
+          return false;
+        }
+
+        pattern++;
+      }
+
+      pattern++;
+    } else {
+      if (!parseByte(pattern, element.set, errorMessage)) return false;
+    }
+
+    minSize += element.gap ? element.minGap : 1;
+    maxSize += element.gap ? element.maxGap : 1;
+    elements.push_back(element);
+  }
+
+  if (elements.empty()) {
+    *errorMessage = "signature is empty";
+    return false;
+  }
+
+  // a gap at the start would only move the match, so it is not allowed
+  if (elements[0].gap) {
+    *errorMessage = "a signature can not start with a gap";
+    return false;
+  }
+
+  firstByte = -1;
+  for (int value = 0; value < 256; value++) {
+    if (!HAS_BYTE(elements[0].set, value)) continue;
+
+    if (firstByte != -1) {
+      firstByte = -1;
+      break;
+    }
+
+    firstByte = value;
+  }
+
+  return true;
+}
+
+/* Elements up to the next gap are compared in a loop, gaps try every length from shortest to longest */
+bool signature::matchFrom(const unsigned char* bytes, SIZE_T length, SIZE_T element, SIZE_T offset, SIZE_T* positions) const {
+  for (; element < elements.size() && !elements[element].gap; element++, offset++) {
+    if (offset >= length || !HAS_BYTE(elements[element].set, bytes[offset])) return false;
+    positions[element] = offset;
+  }
+
+  if (element == elements.size()) {
+    positions[element] = offset;
+    return true;
+  }
+
+  positions[element] = offset;
+  const Element& gap = elements[element];
+
+  for (SIZE_T size = gap.minGap; size <= gap.maxGap && offset + size <= length; size++) {
+    if (matchFrom(bytes, length, element + 1, offset + size, positions)) return true;
+  }
+
+  return false;
+}
+
+bool signature::match(const unsigned char* bytes, SIZE_T length, SIZE_T* positions) const {
+  return matchFrom(bytes, length, 0, 0, positions);
+}
+
+/* Offset of the first match that starts at or before lastOffset, or -1 */
+SIZE_T signature::find(const unsigned char* bytes, SIZE_T length, SIZE_T lastOffset, SIZE_T* positions) const {
+  for (SIZE_T offset = 0; offset <= lastOffset; ++offset) {
+    // skip straight to the next candidate when the first byte is fixed
+    if (firstByte != -1) {
+      const void* next = memchr(bytes + offset, firstByte, lastOffset - offset + 1);
+      if (next == nullptr) break;
+      offset = static_cast<const unsigned char*>(next) - bytes;
+    }
+
+    if (matchFrom(bytes + offset, length - offset, 0, 0, positions)) return offset;
+  }
+
+  return (SIZE_T)-1;
+}
+
+SIZE_T signature::getMinSize() const {
+  return minSize;
+}
+
+SIZE_T signature::getMaxSize() const {
+  return maxSize;
+}
+
+SIZE_T signature::getPositionCount() const {
+  return elements.size() + 1;
+}
+
+/* Offset of a capture from the start of the match, given the positions filled in by match */
+SIZE_T signature::getCaptureOffset(const SIZE_T* positions, int capture) const {
+  return positions[captureElements[capture]];
+}
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef SIGNATURE_H
+#define SIGNATURE_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <string>
+#include <vector>
+
+/* A compiled signature. Besides bytes (`A9`) and wildcards (`?`) a signature can contain
+ * nibble wildcards (`4?`), byte ranges (`70-7F`), alternations (`(E8|E9)`), gaps of a variable
+ * number of bytes (`[2-8]`), named captures (`<name>`) and post-operations (`@rel32(name)`, `@deref(2)`)
+ * that turn the match into the final address. */
+class signature {
+
+public:
+  signature();
+  ~signature();
+
+  struct Element {
+    bool gap;
+    // bytes: bitmap of the byte values that match
+    unsigned char set[32];
+    // gap: number of arbitrary bytes
+    SIZE_T minGap;
+    SIZE_T maxGap;
+  };
+
+  struct Operation {
+    enum Type {
+      // at: continue from a capture
+      // rel32: read a 32 bit displacement and add it to the address of the end of the instruction
+      // deref: read a pointer
+      OP_AT,
+      OP_REL32,
+      OP_DEREF
+    } type;
+    // capture index, or -1 for the current address
+    int capture;
+    // rel32: bytes from the displacement to the end of the instruction, deref: number of reads
+    SIZE_T value;
+  };
+
+  // Largest gap a signature can contain, the reader overlaps its chunks by the largest match
+  static const SIZE_T MAX_GAP = 4096;
+
+  bool compile(const char* pattern, char** errorMessage);
+
+  // positions must have room for getPositionCount() entries, it receives the offset of every element
+  bool match(const unsigned char* bytes, SIZE_T length, SIZE_T* positions) const;
+  SIZE_T find(const unsigned char* bytes, SIZE_T length, SIZE_T lastOffset, SIZE_T* positions) const;
+
+  SIZE_T getMinSize() const;
+  SIZE_T getMaxSize() const;
+  SIZE_T getPositionCount() const;
+  SIZE_T getCaptureOffset(const SIZE_T* positions, int capture) const;
+
+  std::vector<std::string> captureNames;
+  std::vector<Operation> operations;
+
+private:
+  bool matchFrom(const unsigned char* bytes, SIZE_T length, SIZE_T element, SIZE_T offset, SIZE_T* positions) const;
+  bool parseByte(const char*& pattern, unsigned char* set, char** errorMessage);
+  bool parseOperation(const char*& pattern, char** errorMessage);
+  int findCapture(const std::string& name) const;
+
+  std::vector<Element> elements;
+  // element index each capture is taken at
+  std::vector<SIZE_T> captureElements;
+  SIZE_T minSize;
+  SIZE_T maxSize;
+  // the first element if it only matches a single byte value, otherwise -1
+  int firstByte;
+};
+#endif
+#pragma once
@@ -0,0 +1,247 @@
+#include <node.h>
+#include <windows.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "stringscan.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define STRINGSCAN_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const char* encodingNames[stringscan::ENCODING_COUNT] = {
+  "ascii",
+  "utf16le"
+};
+
+stringscan::stringscan() {}
+stringscan::~stringscan() {}
+
+static inline bool isPrintable(unsigned int character) {
+  return (character >= 0x20 && character <= 0x7E) || character == '\t';
+}
+
+static inline int countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return (int)index;
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if (_BitScanForward(&index, (unsigned long)value)) return (int)index;
+  _BitScanForward(&index, (unsigned long)(value >> 32));
+  return (int)index + 32;
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+
+/* One bit per character for the `count` (at most 64) characters at data, set if the character is printable */
+static uint64_t printableMask(const unsigned char* data, SIZE_T count, stringscan::Encoding encoding) {
+  uint64_t mask = 0;
+
+#ifdef STRINGSCAN_SSE2
+  if (count == 64 && encoding == stringscan::ENCODING_ASCII) {
+    // signed compares: bytes from 0x80 up are negative, so they fail the first test
+    const __m128i low = _mm_set1_epi8(0x1F);
+    const __m128i high = _mm_set1_epi8(0x7F);
+    const __m128i tab = _mm_set1_epi8('\t');
+
+    for (int block = 0; block < 4; block++) {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + block * 16));
+      __m128i printable = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi8(bytes, low), _mm_cmplt_epi8(bytes, high)), _mm_cmpeq_epi8(bytes, tab));
+      mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(printable) << (block * 16);
+    }
+
+    return mask;
+  }
+
+  if (count == 64 && encoding == stringscan::ENCODING_UTF16LE) {
+    const __m128i low = _mm_set1_epi16(0x1F);
+    const __m128i high = _mm_set1_epi16(0x7F);
+    const __m128i tab = _mm_set1_epi16('\t');
+
+    for (int block = 0; block < 8; block++) {
+      __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + block * 16));
+      __m128i printable = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi16(units, low), _mm_cmplt_epi16(units, high)), _mm_cmpeq_epi16(units, tab));
+      // narrow the 16 bit lanes to bytes so the mask has one bit per character
+      mask |= (uint64_t)(_mm_movemask_epi8(_mm_packs_epi16(printable, _mm_setzero_si128())) & 0xFF) << (block * 8);
+    }
+
+    return mask;
+  }
+#endif
+
+  for (SIZE_T i = 0; i < count; i++) {
+    unsigned int character = encoding == stringscan::ENCODING_ASCII ? data[i] : data[i * 2] | data[i * 2 + 1] << 8;
+    if (isPrintable(character)) mask |= 1ULL << i;
+  }
+
+  return mask;
+}
+
+/* Adds the strings that start in this chunk to results. A string that starts at the first character
+ * of a chunk is reported by the previous chunk (which can see whether it continues a string), so each
+ * chunk reports strings that start from its second character up to the first character of the next chunk.
+ * A string at the first character goes to heads instead, in case the previous chunk couldn't be read. */
+void stringscan::scanChunk(const reader::Chunk& chunk, bool firstInRange, bool lastInRange, Encoding encoding, const Options& options,
+  std::vector<Result>& results, std::vector<Result>& heads) {
+  const SIZE_T unit = encoding == ENCODING_ASCII ? 1 : 2;
+  const SIZE_T noRun = (SIZE_T)-1;
+  SIZE_T characters = chunk.available / unit;
+  SIZE_T lastStart = lastInRange ? characters : chunk.size / unit;
+
+  auto addString = [&](SIZE_T start, SIZE_T end) {
+    SIZE_T length = (std::min)(end - start, options.maxLength);
+    if (length < options.minLength) return;
+
+    Result result;
+    result.address = chunk.address + start * unit;
+    result.length = length;
+    result.encoding = encoding;
+
+    if (options.text || !options.filter.empty()) {
+      result.text.resize(length);
+      for (SIZE_T i = 0; i < length; i++) result.text[i] = (char)chunk.data[(start + i) * unit];
+
+      size_t found = result.text.find(options.filter);
+      if (found == std::string::npos || (options.prefix && found != 0)) return;
+
+      if (!options.text) result.text.clear();
+    }
+
+    if (start == 0 && !firstInRange) heads.push_back(result);
+    else results.push_back(result);
+  };
+
+  SIZE_T runStart = noRun;
+
+  for (SIZE_T base = 0; base < characters; base += 64) {
+    SIZE_T count = (std::min)((SIZE_T)64, characters - base);
+    uint64_t valid = count == 64 ? ~0ULL : (1ULL << count) - 1;
+    uint64_t printable = printableMask(chunk.data + base * unit, count, encoding);
+    int position = 0;
+
+    // alternate between looking for the start of a run (a set bit) and its end (a clear bit)
+    while (position < (int)count) {
+      uint64_t remaining = valid & (~0ULL << position);
+
+      if (runStart == noRun) {
+        uint64_t starts = printable & remaining;
+        if (starts == 0) break;
+
+        position = countTrailingZeros(starts);
+        runStart = base + position;
+
+        if (runStart > lastStart) return;
+      } else {
+        uint64_t ends = ~printable & remaining;
+        if (ends == 0) break;
+
+        position = countTrailingZeros(ends);
+        addString(runStart, base + position);
+        runStart = noRun;
+      }
+    }
+  }
+
+  // a run that reaches the end of the data
+  if (runStart != noRun) addString(runStart, characters);
+}
+
+/* Scans every range for strings. Ranges are read in chunks with enough overlap for a string of maxLength,
+ * using the bulk reader so the next chunks are read while one is being scanned.
+ * Returns false if the scan was stopped (by the control, onResults, or because maxResults were found),
+ * or if no read buffer could be allocated, in which case errorMessage is set. */
+bool stringscan::findStrings(HANDLE handle, const std::vector<reader::Range>& ranges, const Options& options, reader& Reader,
+  scancontrol* control, const ResultCallback& onResults, char** errorMessage) {
+  SIZE_T found = 0;
+  std::vector<Result> results;
+  std::vector<Result> heads;
+
+  // strings at the first character of a chunk, kept until it is known whether the previous chunk was read
+  std::map<SIZE_T, std::vector<Result>> pendingHeads;
+  std::map<SIZE_T, bool> chunkRead;
+
+  if (control != nullptr) {
+    SIZE_T bytesTotal = 0;
+    for (std::vector<reader::Range>::size_type i = 0; i != ranges.size(); i++) bytesTotal += ranges[i].size;
+    control->begin(bytesTotal);
+  }
+
+  auto report = [&]() {
+    if (results.empty()) return true;
+
+    if (found + results.size() > options.maxResults) results.resize(options.maxResults - found);
+    found += results.size();
+
+    return onResults(results) && found < options.maxResults;
+  };
+
+  bool finished = Reader.readRanges(handle, ranges, options.maxLength * 2, [&](const reader::Chunk& chunk) {
+    results.clear();
+
+    chunkRead[chunk.index] = chunk.success;
+
+    // the strings at the start of the next chunk were this chunk's to report, if it couldn't do so they are reported now
+    std::map<SIZE_T, std::vector<Result>>::iterator next = pendingHeads.find(chunk.index + 1);
+
+    if (next != pendingHeads.end()) {
+      if (!chunk.success) results.swap(next->second);
+      pendingHeads.erase(next);
+    }
+
+    if (!chunk.success) return report();
+
+    const reader::Range& range = ranges[chunk.range];
+    bool firstInRange = chunk.address == range.address;
+    bool lastInRange = chunk.address + chunk.size == range.address + range.size;
+
+    heads.clear();
+
+    for (int encoding = 0; encoding < ENCODING_COUNT; encoding++) {
+      if (options.encodings[encoding]) scanChunk(chunk, firstInRange, lastInRange, (Encoding)encoding, options, results, heads);
+    }
+
+    if (!heads.empty()) {
+      std::map<SIZE_T, bool>::iterator previous = chunkRead.find(chunk.index - 1);
+
+      if (previous == chunkRead.end()) pendingHeads[chunk.index].swap(heads);
+      else if (!previous->second) results.insert(results.end(), heads.begin(), heads.end());
+    }
+
+    return report();
+  }, control, errorMessage);
+
+  if (control != nullptr) control->reportProgress(true);
+
+  return finished;
+}
+
+bool stringscan::parseEncoding(const char* name, Encoding* encoding) {
+  for (int i = 0; i < ENCODING_COUNT; i++) {
+    if (!strcmp(name, encodingNames[i])) {
+      *encoding = (Encoding)i;
+      return true;
+    }
+  }
+
+  // accept the usual spellings of UTF-16LE too
+  if (!strcmp(name, "utf16") || !strcmp(name, "utf-16") || !strcmp(name, "utf-16le") || !strcmp(name, "ucs2")) {
+    *encoding = ENCODING_UTF16LE;
+    return true;
+  }
+
+  return false;
+}
+
+const char* stringscan::getEncodingName(Encoding encoding) {
+  return encodingNames[encoding];
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef STRINGSCAN_H
+#define STRINGSCAN_H
+#define WIN32_LEAN_AND_MEAN
+
+#include <node.h>
+#include <windows.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "reader.h"
+#include "scancontrol.h"
+
+/* Finds runs of printable characters (like the `strings` tool) in ASCII and UTF-16LE.
+ * Printable characters are classified 16 bytes at a time with SSE2, runs are then found
+ * with bit scans over the resulting masks. */
+class stringscan {
+
+public:
+  stringscan();
+  ~stringscan();
+
+  enum Encoding {
+    ENCODING_ASCII,
+    ENCODING_UTF16LE,
+    ENCODING_COUNT
+  };
+
+  // chunks overlap by two bytes per character of maxLength, this keeps the overlap small
+  static const SIZE_T MAX_LENGTH = 0x10000;
+
+  struct Options {
+    SIZE_T minLength;
+    // longer strings are reported with this length, at most MAX_LENGTH
+    SIZE_T maxLength;
+    bool encodings[ENCODING_COUNT];
+    // only report strings that contain (or start with) filter
+    std::string filter;
+    bool prefix;
+    // fill in Result::text
+    bool text;
+    SIZE_T maxResults;
+  };
+
+  // length is in characters, text holds the characters of UTF-16 strings narrowed to one byte
+  struct Result {
+    uintptr_t address;
+    SIZE_T length;
+    Encoding encoding;
+    std::string text;
+  };
+
+  // Called with the strings of every chunk that has some, return false to stop the scan
+  typedef std::function<bool(std::vector<Result>&)> ResultCallback;
+
+  bool findStrings(HANDLE handle, const std::vector<reader::Range>& ranges, const Options& options, reader& Reader,
+    scancontrol* control, const ResultCallback& onResults, char** errorMessage);
+
+  static bool parseEncoding(const char* name, Encoding* encoding);
+  static const char* getEncodingName(Encoding encoding);
+
+private:
+  void scanChunk(const reader::Chunk& chunk, bool firstInRange, bool lastInRange, Encoding encoding, const Options& options,
+    std::vector<Result>& results, std::vector<Result>& heads);
+};
+#endif
+#pragma once